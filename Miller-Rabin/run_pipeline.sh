@@ -26,12 +26,13 @@ echo ""
 
 # Step 2: Compile the batch processing program
 echo "[Step 2/4] Compiling main_batch.cpp..."
+CXXFLAGS="-std=c++17 -O3 -pthread"
 # Added -I src to ensure headers are found safely
 if [ -d "src" ]; then
-    g++ -std=c++11 -O3 -I src src/main_batch.cpp src/miller_rabin.cpp src/trial_division.cpp -o main_batch
+    g++ ${CXXFLAGS} -I src src/main_batch.cpp src/miller_rabin.cpp src/trial_division.cpp src/segmented_sieve.cpp src/prime_bitmap.cpp src/dataset_io.cpp src/factor.cpp src/pseudoprime_search.cpp -o main_batch
     echo "✓ Compiled main_batch"
 else
-    g++ -std=c++11 -O3 main_batch.cpp miller_rabin.cpp trial_division.cpp -o main_batch
+    g++ ${CXXFLAGS} main_batch.cpp miller_rabin.cpp trial_division.cpp segmented_sieve.cpp prime_bitmap.cpp dataset_io.cpp factor.cpp pseudoprime_search.cpp -o main_batch
     echo "✓ Compiled main_batch"
 fi
 echo ""
@@ -42,23 +43,60 @@ RESULTS_DIR="results/"
 PLOTS_DIR="plots/"
 mkdir -p "$RESULTS_DIR" "$PLOTS_DIR"
 
+# Reproducibility: fixed witness seed (override with SEED=...), one pinned core
+# when taskset exists, and a record of what produced the numbers
+SEED=${SEED:-42}
+RUN="./main_batch"
+if command -v taskset >/dev/null 2>&1; then
+    RUN="taskset -c 0 ./main_batch"
+fi
+{
+    echo "date: $(date -u +%Y-%m-%dT%H:%M:%SZ)"
+    echo "commit: $(git rev-parse --short HEAD 2>/dev/null || echo unknown)"
+    echo "compiler: $(g++ --version | head -n 1)"
+    echo "flags: ${CXXFLAGS}"
+    echo "cpu: $(grep -m 1 'model name' /proc/cpuinfo 2>/dev/null | cut -d: -f2 | sed 's/^ //')"
+    echo "seed: ${SEED}"
+    echo "runner: ${RUN}"
+} > ${RESULTS_DIR}run_info.txt
+
 # Step 3: Run all benchmarks
 echo "[Step 3/4] Running benchmarks..."
 echo "  → Benchmarking Trial Division (naive)..."
-./main_batch --bench-naive ${DATA_DIR}dataset_naive.csv > ${RESULTS_DIR}bench_naive.csv
+${RUN} --bench-naive ${DATA_DIR}dataset_naive.csv > ${RESULTS_DIR}bench_naive.csv
 echo "  ✓ ${RESULTS_DIR}bench_naive.csv"
 
 echo "  → Benchmarking Miller-Rabin (k=5)..."
-./main_batch --bench-mr ${DATA_DIR}dataset_mr.csv > ${RESULTS_DIR}bench_mr.csv
+${RUN} --bench-mr ${DATA_DIR}dataset_mr.csv --seed ${SEED} > ${RESULTS_DIR}bench_mr.csv
 echo "  ✓ ${RESULTS_DIR}bench_mr.csv"
 
+echo "  → Benchmarking Baillie-PSW against Miller-Rabin (k=5)..."
+${RUN} --bench-bpsw ${DATA_DIR}dataset_mr.csv --seed ${SEED} > ${RESULTS_DIR}bench_bpsw.csv
+echo "  ✓ ${RESULTS_DIR}bench_bpsw.csv"
+
+if [ ! -f ${DATA_DIR}prime_bitmap.bin ]; then
+    echo "  → Writing the primality bitmap for n < 2^32 (~143 MB, once)..."
+    ./main_batch --write-bitmap ${DATA_DIR}prime_bitmap.bin --threads 0
+fi
+echo "  → Benchmarking bitmap lookups against Miller-Rabin..."
+${RUN} --bench-bitmap ${DATA_DIR}dataset_mr.csv --bitmap ${DATA_DIR}prime_bitmap.bin > ${RESULTS_DIR}bench_bitmap.csv
+echo "  ✓ ${RESULTS_DIR}bench_bitmap.csv"
+
 echo "  → Running error analysis on Carmichael numbers..."
-./main_batch --error-test ${DATA_DIR}dataset_carmichael.csv > ${RESULTS_DIR}error_test.csv
+${RUN} --error-test ${DATA_DIR}dataset_carmichael.csv --seed ${SEED} > ${RESULTS_DIR}error_test.csv
 echo "  ✓ ${RESULTS_DIR}error_test.csv"
 
 echo "  → Running k-scaling analysis..."
-./main_batch --k-test ${DATA_DIR}dataset_k_scaling.csv > ${RESULTS_DIR}k_test.csv
+${RUN} --k-test ${DATA_DIR}dataset_k_scaling.csv --seed ${SEED} > ${RESULTS_DIR}k_test.csv
 echo "  ✓ ${RESULTS_DIR}k_test.csv"
+
+echo "  → Benchmarking random prime generation (8-64 bits)..."
+${RUN} --bench-primegen 64 --seed ${SEED} > ${RESULTS_DIR}bench_primegen.csv
+echo "  ✓ ${RESULTS_DIR}bench_primegen.csv"
+
+echo "  → Benchmarking multi-precision Miller-Rabin (128-4096 bits)..."
+${RUN} --bench-mp ${DATA_DIR}dataset_mp.csv --seed ${SEED} > ${RESULTS_DIR}bench_mp.csv
+echo "  ✓ ${RESULTS_DIR}bench_mp.csv"
 echo ""
 
 # Step 4: Generate plots
@@ -80,6 +118,6 @@ echo "================================================"
 echo ""
 echo "Generated files:"
 echo "  Datasets:  $DATA_DIR"
-echo "  Results:   $RESULTS_DIR"
+echo "  Results:   $RESULTS_DIR (build and machine in ${RESULTS_DIR}run_info.txt)"
 echo "  Plots:     $PLOTS_DIR"
 echo ""
\ No newline at end of file
@@ -118,10 +118,32 @@ def generate_k_scaling_dataset():
     print(f"✓ Generated data/dataset_k_scaling.csv (Prime: {large_prime}, k=1..50)")
 
 
+def generate_mp_dataset():
+    """
+    Generates dataset_mp.csv with multi-precision primes from 128 to 4096 bits
+    (doubling). 3 primes per bit length.
+    """
+    data = []
+    
+    for bit_length in [128, 256, 512, 1024, 2048, 4096]:
+        current = 2 ** (bit_length - 1)
+        for _ in range(3):
+            current = nextprime(current)
+            data.append([current, bit_length])
+    
+    with open('data/dataset_mp.csv', 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(['Number', 'BitLength'])
+        writer.writerows(data)
+    
+    print(f"✓ Generated data/dataset_mp.csv ({len(data)} entries)")
+
+
 if __name__ == '__main__':
     print("Generating datasets for primality testing benchmarks...\n")
     generate_carmichael_dataset()
     generate_naive_dataset()
     generate_mr_dataset()
     generate_k_scaling_dataset()
+    generate_mp_dataset()
     print("\n✓ All datasets generated successfully!")
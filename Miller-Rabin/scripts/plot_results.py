@@ -152,6 +152,11 @@ def plot_k_scaling():
     plt.plot(k_values, trendline, 'r--', linewidth=2, 
              label=f'Linear Fit: y = {slope:.2e}x + {intercept:.2e}\n$R^2$ = {r_value**2:.4f}')
     
+    # Baillie-PSW does not depend on k: one flat line at its mean cost
+    if 'BPSWTimeSec' in df.columns:
+        plt.axhline(df['BPSWTimeSec'].mean(), color='b', linestyle='-', linewidth=2,
+                    label=f"Baillie-PSW (exact, {df['BPSWTimeSec'].mean():.2e}s)")
+    
     plt.xlabel('Number of Iterations (k)', fontsize=14, fontweight='bold')
     plt.ylabel('Average Execution Time (Seconds)', fontsize=14, fontweight='bold')
     plt.title('Miller-Rabin: Execution Time vs. k (Linear Scaling)', 
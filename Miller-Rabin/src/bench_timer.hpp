@@ -0,0 +1,168 @@
+#ifndef BENCH_TIMER_HPP
+#define BENCH_TIMER_HPP
+
+#include <algorithm> // For std::sort
+#include <chrono>    // For steady_clock
+#include <cmath>     // For sqrt, fabs
+#include <cstdint>   // For uint64_t
+#include <ctime>     // For clock_gettime(CLOCK_THREAD_CPUTIME_ID)
+#include <vector>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <x86intrin.h> // For __rdtsc, _mm_lfence
+#define BENCH_HAVE_TSC 1
+#endif
+
+/**
+ * Knobs for measure(). The defaults suit calls from ~100 ns up to ~1 s.
+ */
+struct TimingConfig {
+    bool use_tsc = false;          // Time with rdtsc instead of steady_clock (x86 only)
+    bool use_thread_cpu = false;   // Time with the calling thread's CPU clock (overrides use_tsc)
+    double warmup_sec = 0.002;     // Untimed calls first: caches, branch predictors, page faults
+    double min_sample_sec = 50e-6; // One sample repeats the call until it lasts this long
+    int min_samples = 10;
+    int max_samples = 200;
+    double target_rel_ci = 0.02;   // Stop once the median's CI is within +/-2%
+    double budget_sec = 0.25;      // ... or once this much time went into sampling
+};
+
+/**
+ * Per-call times in seconds, after outlier rejection.
+ */
+struct TimingResult {
+    double median = 0.0;
+    double p95 = 0.0;
+    double ci_low = 0.0;  // 95% confidence interval of the median
+    double ci_high = 0.0;
+    int samples = 0;      // Samples kept
+    int outliers = 0;     // Samples dropped
+    uint64_t reps = 1;    // Calls per sample
+};
+
+/*
+ * Clock sources. rdtsc is fenced so the timed code cannot drift across it,
+ * and its tick rate is calibrated once against steady_clock. The thread CPU
+ * clock only advances while the calling thread runs, so samples taken on
+ * several threads at once do not absorb each other's time slices.
+ */
+inline double steady_seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#ifdef BENCH_HAVE_TSC
+inline uint64_t tsc_ticks() {
+    _mm_lfence();
+    uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+}
+
+inline double tsc_seconds_per_tick() {
+    static const double rate = []() {
+        double s0 = steady_seconds();
+        uint64_t t0 = tsc_ticks();
+        while (steady_seconds() - s0 < 0.02) {}
+        return (steady_seconds() - s0) / (double)(tsc_ticks() - t0);
+    }();
+    return rate;
+}
+#endif
+
+inline double thread_cpu_seconds() {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+inline double bench_now(const TimingConfig& cfg) {
+    if (cfg.use_thread_cpu) return thread_cpu_seconds();
+#ifdef BENCH_HAVE_TSC
+    if (cfg.use_tsc) return tsc_ticks() * tsc_seconds_per_tick();
+#endif
+    return steady_seconds();
+}
+
+/*
+ * Helper: Summary of raw per-call samples. Samples further than 3 scaled
+ * MADs from the median (preemption, interrupts) are dropped first.
+ */
+inline TimingResult summarize_samples(std::vector<double> samples) {
+    TimingResult r;
+    if (samples.empty()) return r;
+
+    std::sort(samples.begin(), samples.end());
+    double med = samples[samples.size() / 2];
+
+    std::vector<double> dev(samples.size());
+    for (size_t i = 0; i < samples.size(); i++) dev[i] = fabs(samples[i] - med);
+    std::sort(dev.begin(), dev.end());
+    double limit = 3.0 * 1.4826 * dev[dev.size() / 2];
+    if (limit < 0.01 * med) limit = 0.01 * med; // Identical samples: keep near-ties
+
+    std::vector<double> kept;
+    for (size_t i = 0; i < samples.size(); i++) {
+        if (fabs(samples[i] - med) <= limit) kept.push_back(samples[i]);
+    }
+
+    size_t n = kept.size();
+    r.samples = (int)n;
+    r.outliers = (int)(samples.size() - n);
+    r.median = n % 2 ? kept[n / 2] : 0.5 * (kept[n / 2 - 1] + kept[n / 2]);
+    r.p95 = kept[(size_t)ceil(0.95 * n) - 1];
+
+    // Distribution-free CI: order statistics n/2 -+ 1.96 * sqrt(n) / 2
+    double half = 0.98 * sqrt((double)n);
+    long lo = (long)floor(n / 2.0 - half);
+    long hi = (long)ceil(n / 2.0 + half);
+    r.ci_low = kept[lo < 0 ? 0 : lo];
+    r.ci_high = kept[hi > (long)n - 1 ? n - 1 : hi];
+    return r;
+}
+
+/**
+ * Times fn() (which returns a value, so it cannot be optimised away):
+ * warm up, pick a repetition count so one sample outlasts clock noise,
+ * then collect samples until the median is precise enough or the budget
+ * is spent, and summarise them.
+ */
+template <typename Fn>
+TimingResult measure(Fn fn, const TimingConfig& cfg = TimingConfig()) {
+    volatile bool sink;
+
+    double start = bench_now(cfg);
+    do {
+        sink = fn();
+    } while (bench_now(cfg) - start < cfg.warmup_sec);
+
+    // Double the repetitions until one sample is long enough
+    uint64_t reps = 1;
+    for (;;) {
+        double t0 = bench_now(cfg);
+        for (uint64_t i = 0; i < reps; i++) sink = fn();
+        if (bench_now(cfg) - t0 >= cfg.min_sample_sec) break;
+        reps *= 2;
+    }
+
+    std::vector<double> samples;
+    double sampling_start = bench_now(cfg);
+    for (;;) {
+        double t0 = bench_now(cfg);
+        for (uint64_t i = 0; i < reps; i++) sink = fn();
+        samples.push_back((bench_now(cfg) - t0) / reps);
+
+        int n = (int)samples.size();
+        if (n >= cfg.max_samples) break;
+        if (n < cfg.min_samples) continue;
+        if (bench_now(cfg) - sampling_start >= cfg.budget_sec) break;
+        TimingResult r = summarize_samples(samples);
+        if (r.median > 0 && (r.ci_high - r.ci_low) / 2 <= cfg.target_rel_ci * r.median) break;
+    }
+    (void)sink;
+
+    TimingResult r = summarize_samples(samples);
+    r.reps = reps;
+    return r;
+}
+
+#endif // BENCH_TIMER_HPP
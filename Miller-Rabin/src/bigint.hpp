@@ -0,0 +1,268 @@
+#ifndef BIGINT_HPP
+#define BIGINT_HPP
+
+#include <cstddef> // For size_t
+#include <cstdint> // For uint64_t
+#include <string>
+
+/**
+ * Fixed-width unsigned integer of Limbs 64-bit words (little-endian).
+ * Only the operations Miller-Rabin needs are provided.
+ */
+template <size_t Limbs>
+struct BigUInt {
+    uint64_t limb[Limbs];
+
+    static BigUInt from_u64(uint64_t v) {
+        BigUInt r;
+        for (size_t i = 0; i < Limbs; i++) r.limb[i] = 0;
+        r.limb[0] = v;
+        return r;
+    }
+
+    /**
+     * Parses a decimal string. Returns false on a bad digit or overflow.
+     */
+    static bool from_string(const std::string& s, BigUInt& out) {
+        out = from_u64(0);
+        if (s.empty()) return false;
+        for (size_t i = 0; i < s.size(); i++) {
+            if (s[i] < '0' || s[i] > '9') return false;
+            // out = out * 10 + digit
+            uint64_t carry = (uint64_t)(s[i] - '0');
+            for (size_t j = 0; j < Limbs; j++) {
+                unsigned __int128 t = (unsigned __int128)out.limb[j] * 10 + carry;
+                out.limb[j] = (uint64_t)t;
+                carry = (uint64_t)(t >> 64);
+            }
+            if (carry) return false;
+        }
+        return true;
+    }
+
+    bool is_zero() const {
+        for (size_t i = 0; i < Limbs; i++) {
+            if (limb[i]) return false;
+        }
+        return true;
+    }
+
+    bool is_odd() const { return limb[0] & 1; }
+
+    bool bit(size_t i) const { return (limb[i / 64] >> (i % 64)) & 1; }
+
+    size_t bit_length() const {
+        for (size_t i = Limbs; i-- > 0;) {
+            if (limb[i]) return i * 64 + 64 - __builtin_clzll(limb[i]);
+        }
+        return 0;
+    }
+
+    /**
+     * Remainder by a small modulus (one 128-bit division per limb).
+     */
+    uint64_t mod_small(uint64_t m) const {
+        unsigned __int128 rem = 0;
+        for (size_t i = Limbs; i-- > 0;) {
+            rem = ((rem << 64) | limb[i]) % m;
+        }
+        return (uint64_t)rem;
+    }
+};
+
+template <size_t Limbs>
+int big_compare(const BigUInt<Limbs>& a, const BigUInt<Limbs>& b) {
+    for (size_t i = Limbs; i-- > 0;) {
+        if (a.limb[i] != b.limb[i]) return a.limb[i] < b.limb[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// a -= b, returns the borrow
+template <size_t Limbs>
+uint64_t big_sub(BigUInt<Limbs>& a, const BigUInt<Limbs>& b) {
+    uint64_t borrow = 0;
+    for (size_t i = 0; i < Limbs; i++) {
+        unsigned __int128 t = (unsigned __int128)a.limb[i] - b.limb[i] - borrow;
+        a.limb[i] = (uint64_t)t;
+        borrow = (uint64_t)(t >> 64) & 1;
+    }
+    return borrow;
+}
+
+// a += b, returns the carry
+template <size_t Limbs>
+uint64_t big_add(BigUInt<Limbs>& a, const BigUInt<Limbs>& b) {
+    uint64_t carry = 0;
+    for (size_t i = 0; i < Limbs; i++) {
+        unsigned __int128 t = (unsigned __int128)a.limb[i] + b.limb[i] + carry;
+        a.limb[i] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+    }
+    return carry;
+}
+
+// a >>= s for s < 64 * Limbs
+template <size_t Limbs>
+void big_shift_right(BigUInt<Limbs>& a, size_t s) {
+    size_t words = s / 64, bits = s % 64;
+    for (size_t i = 0; i < Limbs; i++) {
+        uint64_t lo = i + words < Limbs ? a.limb[i + words] : 0;
+        uint64_t hi = i + words + 1 < Limbs ? a.limb[i + words + 1] : 0;
+        a.limb[i] = bits ? (lo >> bits) | (hi << (64 - bits)) : lo;
+    }
+}
+
+// a <<= 1, dropping the top bit
+template <size_t Limbs>
+void big_shift_left_one(BigUInt<Limbs>& a) {
+    for (size_t i = Limbs; i-- > 1;) {
+        a.limb[i] = (a.limb[i] << 1) | (a.limb[i - 1] >> 63);
+    }
+    a.limb[0] <<= 1;
+}
+
+/**
+ * Decimal representation (repeated division by 10^19).
+ */
+template <size_t Limbs>
+std::string big_to_string(BigUInt<Limbs> a) {
+    const uint64_t CHUNK = 10000000000000000000ULL; // 10^19
+    std::string out;
+    while (!a.is_zero()) {
+        unsigned __int128 rem = 0;
+        for (size_t i = Limbs; i-- > 0;) {
+            unsigned __int128 cur = (rem << 64) | a.limb[i];
+            a.limb[i] = (uint64_t)(cur / CHUNK);
+            rem = cur % CHUNK;
+        }
+        uint64_t r = (uint64_t)rem;
+        for (int d = 0; d < 19; d++) {
+            out.push_back((char)('0' + r % 10));
+            r /= 10;
+        }
+    }
+    while (out.size() > 1 && out.back() == '0') out.pop_back();
+    if (out.empty()) out = "0";
+    return std::string(out.rbegin(), out.rend());
+}
+
+/**
+ * Montgomery context for an odd multi-limb modulus, R = 2^(64 * Limbs).
+ * Multi-limb counterpart of MontgomeryContext in montgomery.hpp.
+ */
+template <size_t Limbs>
+struct MontgomeryMP {
+    typedef BigUInt<Limbs> Num;
+
+    Num n;
+    uint64_t n_neg_inv; // -n^-1 mod 2^64
+    Num r2;             // R^2 mod n
+    Num one;            // R mod n (1 in Montgomery form)
+    Num minus_one;      // n - R mod n
+
+    explicit MontgomeryMP(const Num& modulus) : n(modulus) {
+        uint64_t inv = n.limb[0];
+        for (int i = 0; i < 6; i++) {
+            inv *= 2 - n.limb[0] * inv;
+        }
+        n_neg_inv = 0 - inv;
+
+        // R mod n, then R^2 mod n, by modular doubling; only done once per n
+        Num x = Num::from_u64(1);
+        for (size_t i = 0; i < 64 * Limbs; i++) mod_double(x);
+        one = x;
+        for (size_t i = 0; i < 64 * Limbs; i++) mod_double(x);
+        r2 = x;
+        minus_one = n;
+        big_sub(minus_one, one);
+    }
+
+    // x = 2x mod n, for x < n
+    void mod_double(Num& x) const {
+        uint64_t top = x.limb[Limbs - 1] >> 63;
+        big_shift_left_one(x);
+        if (top || big_compare(x, n) >= 0) big_sub(x, n);
+    }
+
+    /**
+     * a * b * R^-1 mod n (CIOS). Requires a, b < n.
+     */
+    Num mul(const Num& a, const Num& b) const {
+        uint64_t t[Limbs + 2];
+        for (size_t i = 0; i < Limbs + 2; i++) t[i] = 0;
+
+        for (size_t i = 0; i < Limbs; i++) {
+            uint64_t carry = 0;
+            for (size_t j = 0; j < Limbs; j++) {
+                unsigned __int128 s = (unsigned __int128)a.limb[j] * b.limb[i] + t[j] + carry;
+                t[j] = (uint64_t)s;
+                carry = (uint64_t)(s >> 64);
+            }
+            unsigned __int128 s = (unsigned __int128)t[Limbs] + carry;
+            t[Limbs] = (uint64_t)s;
+            t[Limbs + 1] = (uint64_t)(s >> 64);
+
+            uint64_t m = t[0] * n_neg_inv;
+            s = (unsigned __int128)m * n.limb[0] + t[0];
+            carry = (uint64_t)(s >> 64);
+            for (size_t j = 1; j < Limbs; j++) {
+                s = (unsigned __int128)m * n.limb[j] + t[j] + carry;
+                t[j - 1] = (uint64_t)s;
+                carry = (uint64_t)(s >> 64);
+            }
+            s = (unsigned __int128)t[Limbs] + carry;
+            t[Limbs - 1] = (uint64_t)s;
+            t[Limbs] = t[Limbs + 1] + (uint64_t)(s >> 64);
+        }
+
+        Num r;
+        for (size_t i = 0; i < Limbs; i++) r.limb[i] = t[i];
+        if (t[Limbs] || big_compare(r, n) >= 0) big_sub(r, n);
+        return r;
+    }
+
+    Num to_mont(const Num& a) const { return mul(a, r2); }
+
+    /**
+     * base^exp with base in Montgomery form, sliding-window exponentiation.
+     * The window grows with the exponent so large exponents need fewer multiplies.
+     */
+    Num power(const Num& base, const Num& exp) const {
+        size_t bits = exp.bit_length();
+        if (bits == 0) return one;
+
+        int w = bits > 1024 ? 6 : bits > 256 ? 5 : bits > 64 ? 4 : 3;
+
+        // Odd powers base^1, base^3, ..., base^(2^w - 1)
+        Num table[1 << 5];
+        Num base_sq = mul(base, base);
+        table[0] = base;
+        for (int i = 1; i < (1 << (w - 1)); i++) {
+            table[i] = mul(table[i - 1], base_sq);
+        }
+
+        Num res = one;
+        size_t i = bits;
+        while (i > 0) {
+            if (!exp.bit(i - 1)) {
+                res = mul(res, res);
+                i--;
+                continue;
+            }
+            // Longest window [i - len, i) of at most w bits that ends in a 1
+            size_t len = (size_t)w < i ? (size_t)w : i;
+            while (!exp.bit(i - len)) len--;
+            uint64_t value = 0;
+            for (size_t b = 0; b < len; b++) {
+                value = (value << 1) | (uint64_t)exp.bit(i - 1 - b);
+                res = mul(res, res);
+            }
+            res = mul(res, table[value >> 1]);
+            i -= len;
+        }
+        return res;
+    }
+};
+
+#endif // BIGINT_HPP
@@ -0,0 +1,208 @@
+#include "dataset_io.hpp"
+#include <charconv> // For std::from_chars
+#include <cstdio>   // For fopen/fwrite
+#include <cstring>  // For memcmp/memcpy
+#include <fcntl.h>    // For open
+#include <sys/mman.h> // For mmap
+#include <sys/stat.h> // For fstat
+#include <unistd.h>   // For close
+
+/*
+ * Binary layout: header, label_count 32-byte labels, count numbers, count values.
+ * Every section is a multiple of 8 bytes, so both columns stay aligned.
+ */
+static const char DATASET_MAGIC[8] = {'M', 'R', 'D', 'S', 'E', 'T', '0', '1'};
+static const size_t LABEL_BYTES = 32;
+
+struct DatasetHeader {
+    char magic[8];
+    uint64_t count;
+    uint32_t label_count;
+    uint32_t reserved;
+    char value_name[40];
+};
+static_assert(sizeof(DatasetHeader) == 64, "header must stay 64 bytes");
+
+Dataset::~Dataset() {
+    if (mapping) munmap(mapping, mapping_size);
+}
+
+std::string Dataset::value_text(size_t i) const {
+    if (has_labels()) return labels[(size_t)values[i]];
+    return std::to_string(values[i]);
+}
+
+/*
+ * Helper: Map a whole file read-only. Empty files give an empty mapping.
+ */
+static bool map_file(const char* path, void*& mapping, size_t& size) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return false;
+    }
+    size = (size_t)st.st_size;
+    mapping = nullptr;
+    if (size > 0) {
+        mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) mapping = nullptr;
+    }
+    close(fd);
+    if (size > 0 && !mapping) return false;
+    if (mapping) madvise(mapping, size, MADV_SEQUENTIAL); // Read front to back once
+    return true;
+}
+
+static bool load_binary(void* mapping, size_t size, Dataset& dataset) {
+    const DatasetHeader* header = (const DatasetHeader*)mapping;
+    size_t labels_end = sizeof(DatasetHeader) + (size_t)header->label_count * LABEL_BYTES;
+    if (size < labels_end || (size - labels_end) / 16 < header->count) return false;
+
+    const char* base = (const char*)mapping;
+    dataset.value_name.assign(header->value_name, strnlen(header->value_name, sizeof(header->value_name)));
+    for (uint32_t i = 0; i < header->label_count; i++) {
+        const char* label = base + sizeof(DatasetHeader) + i * LABEL_BYTES;
+        dataset.labels.push_back(std::string(label, strnlen(label, LABEL_BYTES)));
+    }
+    dataset.count = header->count;
+    dataset.numbers = (const uint64_t*)(base + labels_end);
+    dataset.values = (const int64_t*)(base + labels_end + header->count * 8);
+
+    // value_text() indexes 'labels' with these, so a damaged file must not get through
+    if (header->label_count > 0) {
+        for (size_t i = 0; i < dataset.count; i++) {
+            if (dataset.values[i] < 0 || (uint64_t)dataset.values[i] >= header->label_count) return false;
+        }
+    }
+    return true;
+}
+
+/*
+ * CSV fast path: one pass over the mapped text with std::from_chars,
+ * no per-line strings or streams. The first data row decides whether the
+ * second column is numeric or text.
+ */
+static void parse_csv(const char* p, const char* end, Dataset& dataset) {
+    // Header: "Number,<value_name>"
+    const char* line_end = (const char*)memchr(p, '\n', end - p);
+    if (!line_end) line_end = end;
+    const char* comma = (const char*)memchr(p, ',', line_end - p);
+    if (comma) {
+        const char* name_end = line_end;
+        while (name_end > comma + 1 && (name_end[-1] == '\r' || name_end[-1] == ' ')) name_end--;
+        dataset.value_name.assign(comma + 1, name_end);
+    }
+    p = line_end < end ? line_end + 1 : end;
+
+    // Each data row is about 20-30 bytes; reserving avoids most regrowth
+    dataset.number_storage.reserve((end - p) / 16 + 1);
+    dataset.value_storage.reserve((end - p) / 16 + 1);
+
+    bool decided = false, text = false;
+    while (p < end) {
+        line_end = (const char*)memchr(p, '\n', end - p);
+        if (!line_end) line_end = end;
+        const char* next = line_end < end ? line_end + 1 : end;
+        const char* field_end = line_end;
+        while (field_end > p && (field_end[-1] == '\r' || field_end[-1] == ' ')) field_end--;
+
+        uint64_t number;
+        std::from_chars_result r = std::from_chars(p, field_end, number);
+        if (r.ec != std::errc() || (r.ptr != field_end && *r.ptr != ',')) {
+            p = next; // Blank or malformed row
+            continue;
+        }
+
+        int64_t value = 0;
+        if (r.ptr != field_end) {
+            const char* field = r.ptr + 1;
+            const char* stop = (const char*)memchr(field, ',', field_end - field);
+            if (!stop) stop = field_end;
+
+            int64_t parsed;
+            std::from_chars_result v = std::from_chars(field, stop, parsed);
+            bool numeric = v.ec == std::errc() && v.ptr == stop;
+            if (!decided) {
+                text = !numeric;
+                decided = true;
+            }
+            if (text) {
+                std::string label(field, stop);
+                size_t idx = 0;
+                while (idx < dataset.labels.size() && dataset.labels[idx] != label) idx++;
+                if (idx == dataset.labels.size()) dataset.labels.push_back(label);
+                value = (int64_t)idx;
+            } else if (numeric) {
+                value = parsed;
+            } else {
+                p = next; // Text in a numeric column
+                continue;
+            }
+        }
+
+        dataset.number_storage.push_back(number);
+        dataset.value_storage.push_back(value);
+        p = next;
+    }
+
+    dataset.count = dataset.number_storage.size();
+    dataset.numbers = dataset.number_storage.data();
+    dataset.values = dataset.value_storage.data();
+}
+
+bool load_dataset(const char* path, Dataset& dataset) {
+    void* mapping;
+    size_t size;
+    if (!map_file(path, mapping, size)) return false;
+
+    if (size >= sizeof(DatasetHeader) && memcmp(mapping, DATASET_MAGIC, sizeof(DATASET_MAGIC)) == 0) {
+        // Keep the mapping: the columns point into it
+        dataset.mapping = mapping;
+        dataset.mapping_size = size;
+        return load_binary(mapping, size, dataset);
+    }
+
+    const char* text = (const char*)mapping;
+    parse_csv(text, text + size, dataset);
+    if (mapping) munmap(mapping, size);
+    return true;
+}
+
+bool write_dataset_binary(const char* path, const std::vector<uint64_t>& numbers,
+                          const std::vector<int64_t>& values, const std::string& value_name,
+                          const std::vector<std::string>& labels) {
+    if (numbers.size() != values.size()) return false;
+    // Longer names would come back cut short
+    if (value_name.size() > sizeof(DatasetHeader::value_name)) return false;
+    for (size_t i = 0; i < labels.size(); i++) {
+        if (labels[i].size() > LABEL_BYTES) return false;
+    }
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    DatasetHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, DATASET_MAGIC, sizeof(DATASET_MAGIC));
+    header.count = numbers.size();
+    header.label_count = (uint32_t)labels.size();
+    memcpy(header.value_name, value_name.data(), value_name.size());
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+    for (size_t i = 0; ok && i < labels.size(); i++) {
+        char label[LABEL_BYTES] = {0};
+        memcpy(label, labels[i].data(), labels[i].size());
+        ok = fwrite(label, LABEL_BYTES, 1, file) == 1;
+    }
+    ok = ok && fwrite(numbers.data(), 8, numbers.size(), file) == numbers.size();
+    ok = ok && fwrite(values.data(), 8, values.size(), file) == values.size();
+    return fclose(file) == 0 && ok;
+}
+
+bool write_dataset_binary(const char* path, const Dataset& dataset) {
+    std::vector<uint64_t> numbers(dataset.numbers, dataset.numbers + dataset.count);
+    std::vector<int64_t> values(dataset.values, dataset.values + dataset.count);
+    return write_dataset_binary(path, numbers, values, dataset.value_name, dataset.labels);
+}
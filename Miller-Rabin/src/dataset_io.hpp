@@ -0,0 +1,67 @@
+#ifndef DATASET_IO_HPP
+#define DATASET_IO_HPP
+
+#include <cstddef> // For size_t
+#include <cstdint> // For uint64_t, int64_t
+#include <string>
+#include <vector>
+
+/**
+ * A two-column dataset: a 64-bit number plus one integer column
+ * (BitLength, k, ...) or one text column (Type) stored as label indices.
+ *
+ * Binary files are memory-mapped and 'numbers' / 'values' point straight
+ * into the mapping, so loading costs no parsing and no copy. CSV files are
+ * mapped too and parsed once with std::from_chars into owned storage.
+ * Not copyable: the pointers refer to this object's own storage.
+ */
+struct Dataset {
+    const uint64_t* numbers = nullptr; // First column
+    const int64_t* values = nullptr;   // Second column, or an index into 'labels'
+    size_t count = 0;
+    std::string value_name;            // Header of the second column
+    std::vector<std::string> labels;   // Non-empty when the second column is text
+
+    std::vector<uint64_t> number_storage; // Used when parsed from CSV
+    std::vector<int64_t> value_storage;
+    void* mapping = nullptr;              // Used when mapped from a binary file
+    size_t mapping_size = 0;
+
+    Dataset() {}
+    Dataset(const Dataset&) = delete;
+    Dataset& operator=(const Dataset&) = delete;
+    ~Dataset();
+
+    bool has_labels() const { return !labels.empty(); }
+
+    /**
+     * Second column as text, e.g. "20" or "Carmichael".
+     */
+    std::string value_text(size_t i) const;
+};
+
+/**
+ * Loads a dataset, telling binary files from CSV by their magic bytes.
+ * Malformed CSV rows are skipped.
+ * @return false if the file cannot be opened or mapped, or if a binary file
+ *         is truncated or has a label index outside its label table.
+ */
+bool load_dataset(const char* path, Dataset& dataset);
+
+/**
+ * Writes 'dataset' in the packed binary format: a 64-byte header, the text
+ * labels (32 bytes each), then the number column and the value column as
+ * contiguous little-endian 64-bit arrays.
+ * @return false (and writes nothing) if a label is longer than 32 bytes or
+ *         the value name longer than 40, since they would not read back intact.
+ */
+bool write_dataset_binary(const char* path, const Dataset& dataset);
+
+/**
+ * Binary writer for generators that produce a numeric column directly.
+ */
+bool write_dataset_binary(const char* path, const std::vector<uint64_t>& numbers,
+                          const std::vector<int64_t>& values, const std::string& value_name,
+                          const std::vector<std::string>& labels = std::vector<std::string>());
+
+#endif // DATASET_IO_HPP
@@ -0,0 +1,103 @@
+#include "factor.hpp"
+#include "miller_rabin.hpp"
+#include "montgomery.hpp"
+#include "trial_division.hpp"
+#include <algorithm> // For std::sort
+#include <cstdint>
+
+// Rho steps between gcds; the product of the differences stands in for each one
+static const uint64_t GCD_BATCH = 128;
+
+/*
+ * Helper: Binary gcd (no divisions)
+ */
+static uint64_t binary_gcd(uint64_t a, uint64_t b) {
+    if (a == 0) return b;
+    if (b == 0) return a;
+    int shift = __builtin_ctzll(a | b);
+    a >>= __builtin_ctzll(a);
+    do {
+        b >>= __builtin_ctzll(b);
+        if (a > b) {
+            uint64_t t = a; a = b; b = t;
+        }
+        b -= a;
+    } while (b != 0);
+    return a << shift;
+}
+
+/*
+ * Pollard-Brent for odd composite n.
+ * Everything stays in Montgomery form: x -> x^2 + c is still a pseudo-random
+ * map there, and gcd(q * R, n) = gcd(q, n) because R = 2^64 is coprime to n.
+ */
+uint64_t pollard_brent(uint64_t n) {
+    MontgomeryContext ctx = mont_init(n);
+
+    // Deterministic sequence of (start, constant) pairs: same input, same work
+    for (uint64_t c0 = 1; ; c0++) {
+        uint64_t c = mont_to(ctx, c0);
+        uint64_t y = mont_to(ctx, c0 + 1);
+        uint64_t x = y, ys = y;
+        uint64_t q = ctx.one;
+        uint64_t g = 1;
+
+        auto step = [&](uint64_t v) {
+            uint64_t s = mont_mul(ctx, v, v) + c;
+            return (s >= n || s < c) ? s - n : s;
+        };
+
+        for (uint64_t r = 1; g == 1; r *= 2) {
+            x = y;
+            for (uint64_t i = 0; i < r; i++) y = step(y);
+
+            for (uint64_t k = 0; k < r && g == 1; k += GCD_BATCH) {
+                ys = y;
+                uint64_t steps = r - k < GCD_BATCH ? r - k : GCD_BATCH;
+                for (uint64_t i = 0; i < steps; i++) {
+                    y = step(y);
+                    q = mont_mul(ctx, q, x > y ? x - y : y - x);
+                }
+                g = binary_gcd(q, n);
+            }
+        }
+
+        if (g == n) {
+            // The batch overshot (or q hit 0): replay it one step at a time
+            do {
+                ys = step(ys);
+                g = binary_gcd(x > ys ? x - ys : ys - x, n);
+            } while (g == 1);
+        }
+
+        if (g != n) return g;
+        // Cycle closed without splitting n: try the next constant
+    }
+}
+
+/*
+ * Helper: Append the prime factors of m, which has no small prime factors.
+ */
+static void factor_large(uint64_t m, std::vector<uint64_t>& factors) {
+    if (m == 1) return;
+    if (m < small_prime_square_limit() || is_prime_deterministic(m)) {
+        factors.push_back(m);
+        return;
+    }
+    uint64_t d = pollard_brent(m);
+    factor_large(d, factors);
+    factor_large(m / d, factors);
+}
+
+std::vector<uint64_t> factor(uint64_t n) {
+    std::vector<uint64_t> factors;
+    if (n <= 1) return factors;
+
+    uint64_t m = strip_small_factors(n, factors);
+    size_t small = factors.size();
+    factor_large(m, factors);
+
+    // Small factors come out in order; the rho ones may not
+    std::sort(factors.begin() + small, factors.end());
+    return factors;
+}
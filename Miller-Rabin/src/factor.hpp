@@ -0,0 +1,24 @@
+#ifndef FACTOR_HPP
+#define FACTOR_HPP
+
+#include <cstdint> // For uint64_t
+#include <vector>
+
+/**
+ * Complete factorisation of n into primes, ascending, with multiplicity
+ * (e.g. 360 -> 2 2 2 3 3 5). Returns an empty list for n <= 1.
+ *
+ * Small primes are removed with the prefilter's inverse-multiply table,
+ * cofactors are checked with deterministic Miller-Rabin, and composites are
+ * split with Pollard's rho using Brent's cycle detection. The rho iteration
+ * runs in Montgomery form and takes one gcd per block of steps instead of
+ * one per step.
+ */
+std::vector<uint64_t> factor(uint64_t n);
+
+/**
+ * One non-trivial divisor of an odd composite n (not necessarily prime).
+ */
+uint64_t pollard_brent(uint64_t n);
+
+#endif // FACTOR_HPP
@@ -2,15 +2,25 @@
 #include <ctime>
 #include <cinttypes>
 #include <cstdint>
+#include <cstdlib>
+#include <chrono>
 #include <iostream>
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <vector>
 #include <cstring>
+#include <charconv>
 
 #include "miller_rabin.hpp"  
 #include "trial_division.hpp"
+#include "parallel.hpp"
+#include "segmented_sieve.hpp"
+#include "prime_bitmap.hpp"
+#include "dataset_io.hpp"
+#include "bench_timer.hpp"
+#include "factor.hpp"
+#include "pseudoprime_search.hpp"
 
 // Utility: Get bit count
 int get_bit_count(uint64_t n) {
@@ -23,165 +33,679 @@ int get_bit_count(uint64_t n) {
     return bits;
 }
 
-// Mode 1: Benchmark Trial Division on dataset_naive.csv
-void bench_naive(const char* filename) {
+// Utility: Wall-clock seconds, for phases that may run on several threads
+static double wall_seconds() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Utility: Load a CSV or binary dataset, timing the ingest phase
+static bool load_timed(const char* filename, Dataset& data, double& ingest_sec) {
+    double start = wall_seconds();
+    if (!load_dataset(filename, data)) {
+        std::cerr << "Error: Could not open or parse " << filename << std::endl;
+        return false;
+    }
+    ingest_sec = wall_seconds() - start;
+    return true;
+}
+
+// Utility: Ingest vs compute split for one mode (stderr keeps stdout a clean CSV)
+static void print_phase_times(double ingest_sec, double compute_sec, size_t rows) {
+    fprintf(stderr, "Ingest: %.6f s for %zu rows, compute: %.6f s\n",
+            ingest_sec, rows, compute_sec);
+}
+
+// Utility: Read the first two columns of every data row as strings
+// (only --bench-mp needs this: its numbers do not fit in 64 bits)
+static bool read_csv_pairs(const char* filename,
+                           std::vector<std::pair<std::string, std::string> >& rows) {
     std::ifstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Error: Could not open " << filename << std::endl;
-        return;
+        return false;
     }
     
-    // Output CSV header
-    printf("Number,BitLength,TimeSec\n");
-    
     std::string line;
     std::getline(file, line); // Skip header
     
     while (std::getline(file, line)) {
         std::istringstream ss(line);
-        std::string num_str, bits_str;
+        std::string first, second;
         
-        if (std::getline(ss, num_str, ',') && std::getline(ss, bits_str, ',')) {
-            uint64_t number = std::stoull(num_str);
-            int bit_length = std::stoi(bits_str);
-            
-            // Time the trial division
-            clock_t start = clock();
-            trial_division(number);
-            clock_t end = clock();
-            
-            double time_sec = (double)(end - start) / CLOCKS_PER_SEC;
-            
-            printf("%" PRIu64 ",%d,%.10f\n", number, bit_length, time_sec);
+        if (std::getline(ss, first, ',') && std::getline(ss, second, ',')) {
+            // Trim any whitespace (e.g. '\r' from Windows line endings)
+            second.erase(second.find_last_not_of(" \n\r\t") + 1);
+            rows.push_back(std::make_pair(first, second));
         }
     }
     file.close();
+    return true;
+}
+
+// Arithmetic back-end used by --bench-mr
+enum ArithMode {
+    ARITH_MONTGOMERY, // Montgomery context built once per n (default)
+    ARITH_CLASSIC,    // 128-bit division on every multiply
+    ARITH_COMPARE     // Time both and report the speedup
+};
+
+// Trial-division engine used by --bench-naive
+enum NaiveEngine {
+    ENGINE_CLASSIC, // Every 6k +/- 1 candidate, two hardware divisions each (default)
+    ENGINE_TABLE,   // Table primes only, inverse-multiply tests, AVX-512 when available
+    ENGINE_COMPARE  // Time both and report the speedup
+};
+
+// Options shared by the batch modes
+struct BatchOptions {
+    ArithMode arith = ARITH_MONTGOMERY;
+    NaiveEngine engine = ENGINE_CLASSIC;
+    bool deterministic = false; // Use the fixed 64-bit witness sets instead of k random bases
+    unsigned threads = 1;       // Worker threads; results are still printed in input order
+    bool prefilter = false;     // Put the small-prime prefilter in front of Miller-Rabin
+    bool count_only = false;    // --range: print pi(b) - pi(a - 1) instead of every prime
+    bool exact = false;         // --error-test: count strong liars instead of sampling
+    const char* bitmap_path = "data/prime_bitmap.bin"; // --bench-bitmap: file to map
+    uint64_t seed = 0;          // Fixed seed for the random witnesses (0 = random)
+    TimingConfig timing;        // Clock, warmup and stopping rules for the timed modes
+};
+
+// Columns written for every TimingResult, after the per-mode key columns
+static const char* TIMING_COLUMNS = "TimeSec,P95Sec,CILowSec,CIHighSec,Samples";
+
+// Utility: Median (as TimeSec), p95, 95% CI of the median and kept sample count
+static void print_timing(const TimingResult& t) {
+    printf("%.10f,%.10f,%.10f,%.10f,%d", t.median, t.p95, t.ci_low, t.ci_high, t.samples);
+}
+
+// Utility: Report which stage settled each candidate (stderr keeps stdout a clean CSV)
+static void print_prefilter_stats(const PrefilterStats& stats) {
+    double total = stats.tested > 0 ? (double)stats.tested : 1.0;
+    fprintf(stderr, "Prefilter stats over %" PRIu64 " candidates:\n", stats.tested);
+    fprintf(stderr, "  small primes: %" PRIu64 " rejected (%.2f%%), %" PRIu64 " proven prime\n",
+            stats.prefilter_composite, 100.0 * stats.prefilter_composite / total,
+            stats.prefilter_prime);
+    fprintf(stderr, "  Miller-Rabin: %" PRIu64 " rejected (%.2f%%), %" PRIu64 " accepted\n",
+            stats.mr_composite, 100.0 * stats.mr_composite / total, stats.mr_prime);
+}
+
+// Mode 1: Benchmark Trial Division on dataset_naive.csv
+void bench_naive(const char* filename, const BatchOptions& opts) {
+    Dataset data;
+    double ingest_sec = 0.0;
+    if (!load_timed(filename, data, ingest_sec)) return;
+    
+    std::vector<TimingResult> classic_sec(data.count), table_sec(data.count);
+    
+    double compute_start = wall_seconds();
+    parallel_for(data.count, opts.threads, [&](size_t i) {
+        // Time the trial division
+        uint64_t number = data.numbers[i];
+        if (opts.engine != ENGINE_TABLE) {
+            classic_sec[i] = measure([number]() { return trial_division(number); }, opts.timing);
+        }
+        if (opts.engine != ENGINE_CLASSIC) {
+            table_sec[i] = measure([number]() { return trial_division_table(number); }, opts.timing);
+        }
+    });
+    double compute_sec = wall_seconds() - compute_start;
+    
+    // Output CSV header
+    if (opts.engine == ENGINE_COMPARE) {
+        printf("Number,BitLength,ClassicSec,TableSec,Speedup\n");
+    } else {
+        printf("Number,BitLength,%s\n", TIMING_COLUMNS);
+    }
+    for (size_t i = 0; i < data.count; i++) {
+        printf("%" PRIu64 ",%" PRId64 ",", data.numbers[i], data.values[i]);
+        if (opts.engine == ENGINE_COMPARE) {
+            double classic = classic_sec[i].median, table = table_sec[i].median;
+            printf("%.10f,%.10f,%.3f", classic, table, table > 0 ? classic / table : 0.0);
+        } else {
+            print_timing(opts.engine == ENGINE_TABLE ? table_sec[i] : classic_sec[i]);
+        }
+        printf("\n");
+    }
+    print_phase_times(ingest_sec, compute_sec, data.count);
+}
+
+// Adapter so the deterministic test fits the (n, k) signature; k is ignored
+static bool deterministic_adapter(uint64_t n, int) {
+    return is_prime_deterministic(n);
+}
+
+// Adapter for Baillie-PSW; k is ignored
+static bool bpsw_adapter(uint64_t n, int) {
+    return is_prime_bpsw(n);
+}
+
+// Prefiltered variants of the two Montgomery tests
+static bool prefiltered_adapter(uint64_t n, int k) {
+    return is_prime_prefiltered(n, k);
+}
+
+static bool prefiltered_deterministic_adapter(uint64_t n, int) {
+    PrefilterResult pre = small_prime_prefilter(n);
+    return pre == PREFILTER_PRIME || (pre == PREFILTER_UNKNOWN && is_prime_deterministic(n));
+}
+
+// Times one Miller-Rabin variant on 'number' with the shared timing layer
+static TimingResult time_mr(bool (*test)(uint64_t, int), uint64_t number, int k,
+                            const TimingConfig& cfg) {
+    return measure([=]() { return test(number, k); }, cfg);
 }
 
 // Mode 2: Benchmark Miller-Rabin (k=5) on dataset_mr.csv
-void bench_mr(const char* filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open " << filename << std::endl;
-        return;
+void bench_mr(const char* filename, const BatchOptions& opts) {
+    Dataset data;
+    double ingest_sec = 0.0;
+    if (!load_timed(filename, data, ingest_sec)) return;
+    
+    // The deterministic test always runs in Montgomery form
+    ArithMode arith = opts.deterministic ? ARITH_MONTGOMERY : opts.arith;
+    bool (*montgomery_test)(uint64_t, int);
+    if (opts.prefilter) {
+        montgomery_test = opts.deterministic ? prefiltered_deterministic_adapter : prefiltered_adapter;
+    } else {
+        montgomery_test = opts.deterministic ? deterministic_adapter : is_prime_miller_rabin;
     }
     
-    printf("Number,BitLength,TimeSec\n");
+    std::vector<TimingResult> classic_sec(data.count), mont_sec(data.count);
     
-    std::string line;
-    std::getline(file, line); // Skip header
+    double compute_start = wall_seconds();
+    parallel_for(data.count, opts.threads, [&](size_t i) {
+        seed_work_item(i);
+        uint64_t number = data.numbers[i];
+        if (arith != ARITH_MONTGOMERY) {
+            classic_sec[i] = time_mr(is_prime_miller_rabin_classic, number, 5, opts.timing);
+        }
+        if (arith != ARITH_CLASSIC) {
+            mont_sec[i] = time_mr(montgomery_test, number, 5, opts.timing);
+        }
+    });
+    double compute_sec = wall_seconds() - compute_start;
     
-    const int ITERATIONS = 1000; // Average over multiple runs for precision
+    if (arith == ARITH_COMPARE) {
+        printf("Number,BitLength,ClassicSec,MontgomerySec,Speedup\n");
+    } else {
+        printf("Number,BitLength,%s\n", TIMING_COLUMNS);
+    }
     
-    while (std::getline(file, line)) {
-        std::istringstream ss(line);
-        std::string num_str, bits_str;
+    for (size_t i = 0; i < data.count; i++) {
+        uint64_t number = data.numbers[i];
+        int64_t bit_length = data.values[i];
         
-        if (std::getline(ss, num_str, ',') && std::getline(ss, bits_str, ',')) {
-            uint64_t number = std::stoull(num_str);
-            int bit_length = std::stoi(bits_str);
-            
-            // Time Miller-Rabin with averaging
-            clock_t start = clock();
-            for (int i = 0; i < ITERATIONS; i++) {
-                is_prime_miller_rabin(number, 5);
-            }
-            clock_t end = clock();
-            
-            double time_sec = ((double)(end - start) / CLOCKS_PER_SEC) / ITERATIONS;
-            
-            printf("%" PRIu64 ",%d,%.10f\n", number, bit_length, time_sec);
+        if (arith == ARITH_COMPARE) {
+            // Medians on both sides
+            double classic = classic_sec[i].median, mont = mont_sec[i].median;
+            double speedup = mont > 0 ? classic / mont : 0.0;
+            printf("%" PRIu64 ",%" PRId64 ",%.10f,%.10f,%.3f\n",
+                   number, bit_length, classic, mont, speedup);
+        } else {
+            printf("%" PRIu64 ",%" PRId64 ",", number, bit_length);
+            print_timing(arith == ARITH_CLASSIC ? classic_sec[i] : mont_sec[i]);
+            printf("\n");
         }
     }
-    file.close();
+    print_phase_times(ingest_sec, compute_sec, data.count);
+    
+    if (opts.prefilter) {
+        // One untimed pass to see which stage settles each number
+        PrefilterStats stats;
+        for (size_t i = 0; i < data.count; i++) {
+            is_prime_prefiltered(data.numbers[i], 5, &stats);
+        }
+        print_prefilter_stats(stats);
+    }
 }
 
 // Mode 3: Error test on Carmichael numbers
-void error_test(const char* filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open " << filename << std::endl;
+void error_test(const char* filename, const BatchOptions& opts) {
+    Dataset data;
+    double ingest_sec = 0.0;
+    if (!load_timed(filename, data, ingest_sec)) return;
+    
+    const int TRIALS = 10000; // Number of trials per (number, k) pair
+    const int MAX_K = 10;     // Test with k from 1 to MAX_K
+    
+    // Only test composites (Carmichael or regular)
+    // Skip if it's actually prime (safety check)
+    std::vector<uint64_t> numbers;
+    std::vector<std::string> types;
+    double compute_start = wall_seconds();
+    for (size_t i = 0; i < data.count; i++) {
+        uint64_t number = data.numbers[i];
+        if (is_prime_deterministic(number)) {
+            continue; // Skip primes
+        }
+        numbers.push_back(number);
+        types.push_back(data.value_text(i));
+    }
+    
+    if (opts.exact) {
+        // One task per number: the liar count gives the rate for every k at once
+        std::vector<uint64_t> liars(numbers.size());
+        parallel_for(numbers.size(), opts.threads, [&](size_t i) {
+            liars[i] = count_strong_liars(numbers[i]);
+        });
+        double compute_sec = wall_seconds() - compute_start;
+        
+        printf("Number,Type,k,StrongLiars,Bases,FalsePositiveRate\n");
+        for (size_t i = 0; i < numbers.size(); i++) {
+            uint64_t bases = numbers[i] - 3; // Witnesses are drawn from [2, n - 2]
+            double per_round = (double)liars[i] / bases;
+            double fpr = 1.0;
+            for (int k = 1; k <= MAX_K; k++) {
+                fpr *= per_round; // Rounds are independent draws
+                printf("%" PRIu64 ",%s,%d,%" PRIu64 ",%" PRIu64 ",%.10e\n",
+                       numbers[i], types[i].c_str(), k, liars[i], bases, fpr);
+            }
+        }
+        print_phase_times(ingest_sec, compute_sec, data.count);
         return;
     }
     
+    // One task per (number, k) pair
+    std::vector<int> false_positives(numbers.size() * MAX_K);
+    
+    parallel_for(false_positives.size(), opts.threads, [&](size_t task) {
+        seed_work_item(task); // Same witnesses for any --threads under --seed
+        uint64_t number = numbers[task / MAX_K];
+        int k = (int)(task % MAX_K) + 1;
+        int count = 0;
+        
+        for (int trial = 0; trial < TRIALS; trial++) {
+            if (is_prime_miller_rabin(number, k)) {
+                count++;
+            }
+        }
+        false_positives[task] = count;
+    });
+    double compute_sec = wall_seconds() - compute_start;
+    
     printf("Number,Type,k,FalsePositives,TotalTrials,FalsePositiveRate\n");
     
-    std::string line;
-    std::getline(file, line); // Skip header
+    for (size_t task = 0; task < false_positives.size(); task++) {
+        size_t i = task / MAX_K;
+        int k = (int)(task % MAX_K) + 1;
+        double fpr = (double)false_positives[task] / TRIALS;
+        printf("%" PRIu64 ",%s,%d,%d,%d,%.10f\n", 
+               numbers[i], types[i].c_str(), k, false_positives[task], TRIALS, fpr);
+    }
+    print_phase_times(ingest_sec, compute_sec, data.count);
+}
+
+// Mode 4: K-scaling test
+void k_test(const char* filename, const BatchOptions& opts) {
+    Dataset data;
+    double ingest_sec = 0.0;
+    if (!load_timed(filename, data, ingest_sec)) return;
     
-    const int TRIALS = 10000; // Number of trials per (number, k) pair
+    std::vector<TimingResult> times(data.count), bpsw_times(data.count);
     
-    while (std::getline(file, line)) {
-        std::istringstream ss(line);
-        std::string num_str, type_str;
+    double compute_start = wall_seconds();
+    parallel_for(data.count, opts.threads, [&](size_t i) {
+        seed_work_item(i);
+        uint64_t number = data.numbers[i];
+        int k = (int)data.values[i];
         
-        if (std::getline(ss, num_str, ',') && std::getline(ss, type_str, ',')) {
-            uint64_t number = std::stoull(num_str);
-            
-            // Trim any whitespace from type_str
-            type_str.erase(type_str.find_last_not_of(" \n\r\t") + 1);
-            
-            // Only test composites (Carmichael or regular)
-            // Skip if it's actually prime (safety check)
-            if (trial_division(number)) {
-                continue; // Skip primes
-            }
-            
-            // Test with k from 1 to 10
-            for (int k = 1; k <= 10; k++) {
-                int false_positives = 0;
-                
-                for (int trial = 0; trial < TRIALS; trial++) {
-                    if (is_prime_miller_rabin(number, k)) {
-                        false_positives++;
-                    }
-                }
-                
-                double fpr = (double)false_positives / TRIALS;
-                printf("%" PRIu64 ",%s,%d,%d,%d,%.10f\n", 
-                       number, type_str.c_str(), k, false_positives, TRIALS, fpr);
-            }
+        // Time Miller-Rabin with this k value
+        // (the deterministic test ignores k and gives a flat baseline)
+        times[i] = time_mr(opts.deterministic ? deterministic_adapter
+                                              : is_prime_miller_rabin,
+                           number, k, opts.timing);
+        // Baillie-PSW on the same number: fixed cost to compare against
+        bpsw_times[i] = time_mr(bpsw_adapter, number, k, opts.timing);
+    });
+    double compute_sec = wall_seconds() - compute_start;
+    
+    printf("Number,k,%s,BPSWTimeSec\n", TIMING_COLUMNS);
+    for (size_t i = 0; i < data.count; i++) {
+        printf("%" PRIu64 ",%" PRId64 ",", data.numbers[i], data.values[i]);
+        print_timing(times[i]);
+        printf(",%.10f\n", bpsw_times[i].median);
+    }
+    print_phase_times(ingest_sec, compute_sec, data.count);
+}
+
+// Mode 5: Benchmark Baillie-PSW against Miller-Rabin (k=5) on dataset_mr.csv
+void bench_bpsw(const char* filename, const BatchOptions& opts) {
+    Dataset data;
+    double ingest_sec = 0.0;
+    if (!load_timed(filename, data, ingest_sec)) return;
+    
+    std::vector<TimingResult> bpsw_sec(data.count), mr_sec(data.count);
+    
+    double compute_start = wall_seconds();
+    parallel_for(data.count, opts.threads, [&](size_t i) {
+        seed_work_item(i);
+        uint64_t number = data.numbers[i];
+        bpsw_sec[i] = time_mr(bpsw_adapter, number, 5, opts.timing);
+        mr_sec[i] = time_mr(opts.deterministic ? deterministic_adapter : is_prime_miller_rabin,
+                            number, 5, opts.timing);
+    });
+    double compute_sec = wall_seconds() - compute_start;
+    
+    // Medians, plus the p95 that shows the tail-latency difference
+    printf("Number,BitLength,BPSWSec,BPSWP95Sec,MillerRabinSec,MillerRabinP95Sec\n");
+    for (size_t i = 0; i < data.count; i++) {
+        printf("%" PRIu64 ",%" PRId64 ",%.10f,%.10f,%.10f,%.10f\n",
+               data.numbers[i], data.values[i], bpsw_sec[i].median, bpsw_sec[i].p95,
+               mr_sec[i].median, mr_sec[i].p95);
+    }
+    print_phase_times(ingest_sec, compute_sec, data.count);
+}
+
+// Mode 6: Stream a whole dataset through the batched primality API
+void batch_test(const char* filename, const BatchOptions& opts) {
+    Dataset data;
+    double ingest_sec = 0.0;
+    if (!load_timed(filename, data, ingest_sec)) return;
+    
+    // Binary datasets are mapped, so is_prime_batch reads the file pages directly
+    const size_t SLICE = 4096; // Candidates handed to is_prime_batch per task
+    std::vector<uint8_t> results(data.count);
+    size_t slices = (data.count + SLICE - 1) / SLICE;
+    std::vector<PrefilterStats> slice_stats(slices);
+    
+    // Wall-clock time, since the slices run concurrently
+    double compute_start = wall_seconds();
+    parallel_for(slices, opts.threads, [&](size_t s) {
+        size_t begin = s * SLICE;
+        size_t len = data.count - begin < SLICE ? data.count - begin : SLICE;
+        is_prime_batch(data.numbers + begin, len, results.data() + begin, &slice_stats[s]);
+    });
+    double compute_sec = wall_seconds() - compute_start;
+    
+    PrefilterStats stats;
+    for (size_t s = 0; s < slices; s++) {
+        stats.merge(slice_stats[s]);
+    }
+    
+    // Rows are formatted with to_chars into one buffer and written in large blocks
+    double output_start = wall_seconds();
+    const size_t OUT_BYTES = 1 << 20;
+    std::vector<char> out(OUT_BYTES);
+    size_t used = 0, primes = 0;
+    fputs("Number,IsPrime\n", stdout);
+    for (size_t i = 0; i < data.count; i++) {
+        if (used > OUT_BYTES - 32) { // A row is at most 20 digits + ",0\n"
+            fwrite(out.data(), 1, used, stdout);
+            used = 0;
         }
+        char* p = std::to_chars(out.data() + used, out.data() + OUT_BYTES, data.numbers[i]).ptr;
+        *p++ = ',';
+        *p++ = results[i] ? '1' : '0';
+        *p++ = '\n';
+        used = p - out.data();
+        primes += results[i];
     }
-    file.close();
+    fwrite(out.data(), 1, used, stdout);
+    fflush(stdout);
+    double output_sec = wall_seconds() - output_start;
+    
+    // Summary goes to stderr so stdout stays a clean CSV
+    fprintf(stderr, "Tested %zu numbers (%zu prime) in %.6f s: %.0f numbers/sec\n",
+            data.count, primes, compute_sec, compute_sec > 0 ? data.count / compute_sec : 0.0);
+    fprintf(stderr, "Ingest: %.6f s, compute: %.6f s, output: %.6f s\n",
+            ingest_sec, compute_sec, output_sec);
+    print_prefilter_stats(stats);
 }
 
-// Mode 4: K-scaling test
-void k_test(const char* filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
-        std::cerr << "Error: Could not open " << filename << std::endl;
+// Times one multi-precision width; samples = 0 if the number does not fit
+template <size_t Bits>
+static TimingResult time_mp_width(const std::string& num_str, int k, const TimingConfig& cfg) {
+    BigUInt<Bits / 64> n;
+    if (!BigUInt<Bits / 64>::from_string(num_str, n)) return TimingResult();
+    return measure([&]() { return is_prime_miller_rabin_mp<Bits>(n, k); }, cfg);
+}
+
+// Picks the narrowest supported width that holds 'bits'
+static TimingResult time_mp(const std::string& num_str, int bits, int k, const TimingConfig& cfg) {
+    if (bits <= 128)  return time_mp_width<128>(num_str, k, cfg);
+    if (bits <= 256)  return time_mp_width<256>(num_str, k, cfg);
+    if (bits <= 512)  return time_mp_width<512>(num_str, k, cfg);
+    if (bits <= 1024) return time_mp_width<1024>(num_str, k, cfg);
+    if (bits <= 2048) return time_mp_width<2048>(num_str, k, cfg);
+    if (bits <= 4096) return time_mp_width<4096>(num_str, k, cfg);
+    return TimingResult();
+}
+
+// Mode 7: Benchmark multi-precision Miller-Rabin (k=5) on dataset_mp.csv
+void bench_mp(const char* filename, const BatchOptions& opts) {
+    std::vector<std::pair<std::string, std::string> > rows;
+    double ingest_start = wall_seconds();
+    if (!read_csv_pairs(filename, rows)) return;
+    double ingest_sec = wall_seconds() - ingest_start;
+    
+    std::vector<TimingResult> times(rows.size());
+    
+    double compute_start = wall_seconds();
+    parallel_for(rows.size(), opts.threads, [&](size_t i) {
+        seed_work_item(i);
+        times[i] = time_mp(rows[i].first, std::stoi(rows[i].second), 5, opts.timing);
+    });
+    double compute_sec = wall_seconds() - compute_start;
+    
+    printf("Number,BitLength,%s\n", TIMING_COLUMNS);
+    for (size_t i = 0; i < rows.size(); i++) {
+        if (times[i].samples == 0) {
+            std::cerr << "Warning: skipping " << rows[i].second
+                      << "-bit entry (unparsable or wider than 4096 bits)\n";
+            continue;
+        }
+        printf("%s,%s,", rows[i].first.c_str(), rows[i].second.c_str());
+        print_timing(times[i]);
+        printf("\n");
+    }
+    print_phase_times(ingest_sec, compute_sec, rows.size());
+}
+
+// Mode 8: Write the primality bitmap for n < 2^32 to 'path'
+void write_bitmap(const char* path, const BatchOptions& opts) {
+    auto start = std::chrono::steady_clock::now();
+    if (!write_prime_bitmap(path, PRIME_BITMAP_LIMIT, opts.threads)) {
+        std::cerr << "Error: Could not write " << path << std::endl;
         return;
     }
+    auto end = std::chrono::steady_clock::now();
+    fprintf(stderr, "Wrote %s (%" PRIu64 " bytes of bitmap) in %.3f s\n", path,
+            (PRIME_BITMAP_LIMIT + 29) / 30, std::chrono::duration<double>(end - start).count());
+}
+
+// Mode 9: Bitmap lookups vs deterministic Miller-Rabin, grouped by bit length
+void bench_bitmap(const char* filename, const BatchOptions& opts) {
+    Dataset data;
+    double ingest_sec = 0.0;
+    if (!load_timed(filename, data, ingest_sec)) return;
     
-    printf("Number,k,TimeSec\n");
+    PrimeBitmap bitmap;
+    if (!open_prime_bitmap(opts.bitmap_path, bitmap)) {
+        std::cerr << "Error: Could not map " << opts.bitmap_path
+                  << " (create it with --write-bitmap)" << std::endl;
+        return;
+    }
     
-    std::string line;
-    std::getline(file, line); // Skip header
+    // Group the numbers by bit length, keeping first-seen order
+    std::vector<int> bit_lengths;
+    std::vector<std::vector<uint64_t> > groups;
+    for (size_t i = 0; i < data.count; i++) {
+        int bits = (int)data.values[i];
+        size_t g = 0;
+        while (g < bit_lengths.size() && bit_lengths[g] != bits) g++;
+        if (g == bit_lengths.size()) {
+            bit_lengths.push_back(bits);
+            groups.push_back(std::vector<uint64_t>());
+        }
+        groups[g].push_back(data.numbers[i]);
+    }
     
-    const int ITERATIONS = 100; // Average for precision
+    std::vector<size_t> hits(groups.size());
+    std::vector<double> lookup_ns(groups.size()), mr_ns(groups.size());
     
-    while (std::getline(file, line)) {
-        std::istringstream ss(line);
-        std::string num_str, k_str;
+    double compute_start = wall_seconds();
+    parallel_for(groups.size(), opts.threads, [&](size_t g) {
+        const std::vector<uint64_t>& nums = groups[g];
+        size_t h = 0;
+        for (size_t i = 0; i < nums.size(); i++) {
+            if (nums[i] < bitmap.limit) h++;
+        }
+        hits[g] = h;
         
-        if (std::getline(ss, num_str, ',') && std::getline(ss, k_str, ',')) {
-            uint64_t number = std::stoull(num_str);
-            int k = std::stoi(k_str);
-            
-            // Time Miller-Rabin with this k value
-            clock_t start = clock();
-            for (int i = 0; i < ITERATIONS; i++) {
-                is_prime_miller_rabin(number, k);
-            }
-            clock_t end = clock();
-            
-            double time_sec = ((double)(end - start) / CLOCKS_PER_SEC) / ITERATIONS;
-            
-            printf("%" PRIu64 ",%d,%.10f\n", number, k, time_sec);
+        // One timed call answers the whole group; the warmup faults the pages in
+        TimingResult mapped = measure([&]() {
+            size_t primes = 0;
+            for (size_t i = 0; i < nums.size(); i++) primes += is_prime_mapped(bitmap, nums[i]);
+            return primes > nums.size();
+        }, opts.timing);
+        TimingResult mr = measure([&]() {
+            size_t primes = 0;
+            for (size_t i = 0; i < nums.size(); i++) primes += is_prime_deterministic(nums[i]);
+            return primes > nums.size();
+        }, opts.timing);
+        lookup_ns[g] = mapped.median * 1e9 / nums.size();
+        mr_ns[g] = mr.median * 1e9 / nums.size();
+    });
+    double compute_sec = wall_seconds() - compute_start;
+    
+    printf("BitLength,Queries,BitmapHits,HitRate,MappedNs,MillerRabinNs\n");
+    size_t total = 0, total_hits = 0;
+    for (size_t g = 0; g < groups.size(); g++) {
+        printf("%d,%zu,%zu,%.4f,%.2f,%.2f\n", bit_lengths[g], groups[g].size(), hits[g],
+               (double)hits[g] / groups[g].size(), lookup_ns[g], mr_ns[g]);
+        total += groups[g].size();
+        total_hits += hits[g];
+    }
+    fprintf(stderr, "Bitmap answered %zu of %zu queries (%.1f%%); the rest fell back to Miller-Rabin\n",
+            total_hits, total, total ? 100.0 * total_hits / total : 0.0);
+    print_phase_times(ingest_sec, compute_sec, data.count);
+    
+    close_prime_bitmap(bitmap);
+}
+
+// Mode 10: Fully factor every number in a dataset
+void factor_dataset(const char* filename, const BatchOptions& opts) {
+    Dataset data;
+    double ingest_sec = 0.0;
+    if (!load_timed(filename, data, ingest_sec)) return;
+    
+    // Small slices: one hard semiprime can cost as much as thousands of easy numbers
+    const size_t SLICE = 256;
+    std::vector<std::vector<uint64_t> > factors(data.count);
+    size_t slices = (data.count + SLICE - 1) / SLICE;
+    
+    double compute_start = wall_seconds();
+    parallel_for(slices, opts.threads, [&](size_t s) {
+        size_t end = (s + 1) * SLICE < data.count ? (s + 1) * SLICE : data.count;
+        for (size_t i = s * SLICE; i < end; i++) {
+            factors[i] = factor(data.numbers[i]);
         }
+    });
+    double compute_sec = wall_seconds() - compute_start;
+    
+    // Factors are joined with '*', e.g. 360,2*2*2*3*3*5
+    size_t total_factors = 0;
+    printf("Number,Factors\n");
+    for (size_t i = 0; i < data.count; i++) {
+        printf("%" PRIu64 ",", data.numbers[i]);
+        for (size_t j = 0; j < factors[i].size(); j++) {
+            printf(j ? "*%" PRIu64 : "%" PRIu64, factors[i][j]);
+        }
+        printf("\n");
+        total_factors += factors[i].size();
+    }
+    
+    fprintf(stderr, "Factored %zu numbers (%zu prime factors) in %.6f s: %.0f numbers/sec\n",
+            data.count, total_factors, compute_sec, compute_sec > 0 ? data.count / compute_sec : 0.0);
+    print_phase_times(ingest_sec, compute_sec, data.count);
+}
+
+// Mode 11: Convert a CSV dataset to the packed binary format
+void convert_dataset(const char* in_path, const char* out_path) {
+    Dataset data;
+    double ingest_sec = 0.0;
+    if (!load_timed(in_path, data, ingest_sec)) return;
+    
+    double start = wall_seconds();
+    if (!write_dataset_binary(out_path, data)) {
+        std::cerr << "Error: Could not write " << out_path
+                  << " (labels are limited to 32 bytes, the value name to 40)" << std::endl;
+        return;
+    }
+    fprintf(stderr, "Converted %zu rows (%s column) to %s: ingest %.6f s, write %.6f s\n",
+            data.count, data.value_name.c_str(), out_path, ingest_sec, wall_seconds() - start);
+}
+
+// Mode 12: Enumerate or count the primes in [a, b] with the segmented sieve
+void range_primes(uint64_t a, uint64_t b, const BatchOptions& opts) {
+    auto start = std::chrono::steady_clock::now();
+    uint64_t count;
+    
+    if (opts.count_only) {
+        count = count_primes_in_range(a, b, opts.threads);
+        printf("RangeStart,RangeEnd,PrimeCount\n");
+        printf("%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", a, b, count);
+    } else {
+        std::vector<uint64_t> primes = primes_in_range(a, b, opts.threads);
+        count = primes.size();
+        // Same layout as the datasets, so the output can be fed back to --batch
+        printf("Number\n");
+        for (size_t i = 0; i < primes.size(); i++) {
+            printf("%" PRIu64 "\n", primes[i]);
+        }
+    }
+    
+    auto end = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(end - start).count();
+    double width = (double)(b - a) + 1.0;
+    fprintf(stderr, "Found %" PRIu64 " primes in [%" PRIu64 ", %" PRIu64 "] in %.6f s: %.0f numbers/sec\n",
+            count, a, b, sec, sec > 0 ? width / sec : 0.0);
+}
+
+// Baseline for --bench-primegen: draw random odd candidates until one passes
+// (the same exact test random_prime() uses, so only the candidate stream differs)
+static uint64_t random_prime_naive(int bits) {
+    uint64_t lo = 1ULL << (bits - 1);
+    uint64_t hi = bits == 64 ? UINT64_MAX : (1ULL << bits) - 1;
+    for (;;) {
+        uint64_t candidate = get_random_range_public(lo, hi) | 1;
+        if (is_prime_deterministic(candidate)) return candidate;
+    }
+}
+
+// Mode 13: Primes per second from random_prime() for 8, 16, ..., max_bits bits
+void bench_primegen(int max_bits, const BatchOptions& opts) {
+    printf("Bits,PrimesPerSec,NaivePrimesPerSec,Speedup,%s\n", TIMING_COLUMNS);
+    for (int bits = 8; bits <= max_bits; bits += 8) {
+        TimingResult sieved = measure([bits]() { return random_prime(bits) != 0; }, opts.timing);
+        TimingResult naive = measure([bits]() { return random_prime_naive(bits) != 0; }, opts.timing);
+
+        double rate = sieved.median > 0 ? 1.0 / sieved.median : 0.0;
+        double naive_rate = naive.median > 0 ? 1.0 / naive.median : 0.0;
+        printf("%d,%.0f,%.0f,%.3f,", bits, rate, naive_rate, naive_rate > 0 ? rate / naive_rate : 0.0);
+        print_timing(sieved);
+        printf("\n");
     }
-    file.close();
+}
+
+// Mode 14: List Carmichael numbers and base-2 strong pseudoprimes up to 'bound'
+void search_pseudoprimes(uint64_t bound, const BatchOptions& opts) {
+    double start = wall_seconds();
+    std::vector<Pseudoprime> found = find_pseudoprimes(bound, opts.threads);
+    double sec = wall_seconds() - start;
+    
+    // Same layout as dataset_carmichael.csv, so the output feeds --error-test directly
+    static const char* TYPE_NAMES[] = {"", "Carmichael", "StrongPseudoprime", "Carmichael+StrongPseudoprime"};
+    size_t carmichael = 0, strong = 0;
+    printf("Number,Type\n");
+    for (size_t i = 0; i < found.size(); i++) {
+        printf("%" PRIu64 ",%s\n", found[i].n, TYPE_NAMES[found[i].kinds]);
+        if (found[i].kinds & PSEUDOPRIME_CARMICHAEL) carmichael++;
+        if (found[i].kinds & PSEUDOPRIME_STRONG_BASE2) strong++;
+    }
+    
+    fprintf(stderr, "Up to %" PRIu64 ": %zu Carmichael numbers, %zu base-2 strong pseudoprimes in %.6f s\n",
+            bound, carmichael, strong, sec);
 }
 
 void print_usage() {
@@ -190,25 +714,185 @@ void print_usage() {
     std::cerr << "  ./main_batch --bench-mr <file.csv>      # Benchmark Miller-Rabin (k=5)\n";
     std::cerr << "  ./main_batch --error-test <file.csv>    # Error analysis on composites\n";
     std::cerr << "  ./main_batch --k-test <file.csv>        # K-scaling analysis\n";
+    std::cerr << "  ./main_batch --bench-bpsw <file.csv>    # Benchmark Baillie-PSW vs Miller-Rabin (k=5)\n";
+    std::cerr << "  ./main_batch --batch <file.csv>         # Batched deterministic test of every number\n";
+    std::cerr << "  ./main_batch --factor <file.csv>        # Prime factorisation of every number\n";
+    std::cerr << "  ./main_batch --bench-mp <file.csv>      # Benchmark 128- to 4096-bit Miller-Rabin (k=5)\n";
+    std::cerr << "  ./main_batch --write-bitmap <file.bin>  # Write the primality bitmap for n < 2^32\n";
+    std::cerr << "  ./main_batch --bench-bitmap <file.csv>  # Bitmap lookup vs Miller-Rabin by bit length\n";
+    std::cerr << "  ./main_batch --convert <in.csv> <out.bin> # Pack a CSV dataset into the binary format\n";
+    std::cerr << "  ./main_batch --range <a> <b>            # Primes in [a, b] via segmented sieve\n";
+    std::cerr << "  ./main_batch --bench-primegen <bits>    # random_prime() rate for 8, 16, ..., <bits> bits\n";
+    std::cerr << "  ./main_batch --pseudoprimes <bound>     # Carmichael numbers and base-2 strong pseudoprimes up to <bound>\n";
+    std::cerr << "\nOptions:\n";
+    std::cerr << "  --arith montgomery|classic|compare      # --bench-mr arithmetic (default: montgomery)\n";
+    std::cerr << "  --engine classic|table|compare          # --bench-naive trial division (default: classic)\n";
+    std::cerr << "  --witness random|deterministic          # --bench-mr/--bench-bpsw/--k-test bases (default: random)\n";
+    std::cerr << "  --prefilter                             # --bench-mr: small-prime filter before Miller-Rabin\n";
+    std::cerr << "  --exact                                 # --error-test: exact rates from strong-liar counts\n";
+    std::cerr << "  --bitmap <file.bin>                     # --bench-bitmap: bitmap to map (default: data/prime_bitmap.bin)\n";
+    std::cerr << "  --count                                 # --range: print only the prime count\n";
+    std::cerr << "  --seed N                                # Reproducible random witnesses (default: random)\n";
+    std::cerr << "  --clock steady|tsc|cpu                  # Timer for the timed modes (default: steady, cpu with --threads > 1)\n";
+    std::cerr << "  --budget SEC                            # Max sampling time per measurement (default: 0.25)\n";
+    std::cerr << "  --threads N                             # Worker threads for any mode (0 = all cores)\n";
+    std::cerr << "\nEvery <file.csv> (except --bench-mp) may also be a binary dataset from --convert.\n";
 }
 
 int main(int argc, char* argv[]) {
-    if (argc != 3) {
+    if (argc < 3) {
         print_usage();
         return 1;
     }
     
     const char* mode = argv[1];
     const char* filename = argv[2];
+    BatchOptions opts;
+    
+    // --range takes two numbers instead of a file, --convert takes two files
+    bool is_range = strcmp(mode, "--range") == 0;
+    bool is_convert = strcmp(mode, "--convert") == 0;
+    if ((is_range || is_convert) && argc < 4) {
+        print_usage();
+        return 1;
+    }
+    
+    // Results are written in large blocks rather than line by line
+    static char stdout_buffer[1 << 20];
+    setvbuf(stdout, stdout_buffer, _IOFBF, sizeof(stdout_buffer));
+    
+    // Trailing options
+    for (int i = (is_range || is_convert) ? 4 : 3; i < argc; i++) {
+        if (strcmp(argv[i], "--arith") == 0 && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (strcmp(value, "montgomery") == 0) {
+                opts.arith = ARITH_MONTGOMERY;
+            } else if (strcmp(value, "classic") == 0) {
+                opts.arith = ARITH_CLASSIC;
+            } else if (strcmp(value, "compare") == 0) {
+                opts.arith = ARITH_COMPARE;
+            } else {
+                std::cerr << "Error: Unknown arithmetic '" << value << "'\n";
+                print_usage();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--engine") == 0 && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (strcmp(value, "classic") == 0) {
+                opts.engine = ENGINE_CLASSIC;
+            } else if (strcmp(value, "table") == 0) {
+                opts.engine = ENGINE_TABLE;
+            } else if (strcmp(value, "compare") == 0) {
+                opts.engine = ENGINE_COMPARE;
+            } else {
+                std::cerr << "Error: Unknown engine '" << value << "'\n";
+                print_usage();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--witness") == 0 && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (strcmp(value, "random") == 0) {
+                opts.deterministic = false;
+            } else if (strcmp(value, "deterministic") == 0) {
+                opts.deterministic = true;
+            } else {
+                std::cerr << "Error: Unknown witness mode '" << value << "'\n";
+                print_usage();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--count") == 0) {
+            opts.count_only = true;
+        } else if (strcmp(argv[i], "--bitmap") == 0 && i + 1 < argc) {
+            opts.bitmap_path = argv[++i];
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            opts.seed = std::stoull(argv[++i]);
+        } else if (strcmp(argv[i], "--clock") == 0 && i + 1 < argc) {
+            const char* value = argv[++i];
+            if (strcmp(value, "steady") == 0) {
+                opts.timing.use_tsc = false;
+            } else if (strcmp(value, "cpu") == 0) {
+                opts.timing.use_thread_cpu = true;
+            } else if (strcmp(value, "tsc") == 0) {
+#ifdef BENCH_HAVE_TSC
+                opts.timing.use_tsc = true;
+#else
+                std::cerr << "Warning: rdtsc not available, using steady_clock\n";
+#endif
+            } else {
+                std::cerr << "Error: Unknown clock '" << value << "'\n";
+                print_usage();
+                return 1;
+            }
+        } else if (strcmp(argv[i], "--budget") == 0 && i + 1 < argc) {
+            opts.timing.budget_sec = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--exact") == 0) {
+            opts.exact = true;
+        } else if (strcmp(argv[i], "--prefilter") == 0) {
+            opts.prefilter = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            int threads = atoi(argv[++i]);
+            if (threads < 0) {
+                std::cerr << "Error: --threads must be >= 0\n";
+                return 1;
+            }
+            opts.threads = threads == 0 ? hardware_threads() : (unsigned)threads;
+        } else {
+            std::cerr << "Error: Unknown option '" << argv[i] << "'\n";
+            print_usage();
+            return 1;
+        }
+    }
+    
+    if (opts.seed != 0) set_random_seed(opts.seed);
+    
+    // Concurrent timed loops share cores and caches; a wall clock would also
+    // count every time slice lost to the other workers
+    if (opts.threads > 1) opts.timing.use_thread_cpu = true;
     
     if (strcmp(mode, "--bench-naive") == 0) {
-        bench_naive(filename);
+        bench_naive(filename, opts);
     } else if (strcmp(mode, "--bench-mr") == 0) {
-        bench_mr(filename);
+        bench_mr(filename, opts);
     } else if (strcmp(mode, "--error-test") == 0) {
-        error_test(filename);
+        error_test(filename, opts);
     } else if (strcmp(mode, "--k-test") == 0) {
-        k_test(filename);
+        k_test(filename, opts);
+    } else if (strcmp(mode, "--bench-bpsw") == 0) {
+        bench_bpsw(filename, opts);
+    } else if (strcmp(mode, "--batch") == 0) {
+        batch_test(filename, opts);
+    } else if (strcmp(mode, "--factor") == 0) {
+        factor_dataset(filename, opts);
+    } else if (strcmp(mode, "--write-bitmap") == 0) {
+        write_bitmap(filename, opts);
+    } else if (strcmp(mode, "--bench-bitmap") == 0) {
+        bench_bitmap(filename, opts);
+    } else if (strcmp(mode, "--bench-mp") == 0) {
+        bench_mp(filename, opts);
+    } else if (is_convert) {
+        convert_dataset(argv[2], argv[3]);
+    } else if (strcmp(mode, "--bench-primegen") == 0) {
+        int max_bits = atoi(argv[2]);
+        if (max_bits < 8 || max_bits > 64) {
+            std::cerr << "Error: --bench-primegen takes a bit size from 8 to 64\n";
+            return 1;
+        }
+        bench_primegen(max_bits, opts);
+    } else if (strcmp(mode, "--pseudoprimes") == 0) {
+        uint64_t bound = std::stoull(argv[2]);
+        if (bound > PSEUDOPRIME_SEARCH_LIMIT) {
+            std::cerr << "Error: --pseudoprimes bound must be at most 2^48\n";
+            return 1;
+        }
+        search_pseudoprimes(bound, opts);
+    } else if (is_range) {
+        uint64_t a = std::stoull(argv[2]);
+        uint64_t b = std::stoull(argv[3]);
+        if (a > b) {
+            std::cerr << "Error: Range start must not exceed range end\n";
+            return 1;
+        }
+        range_primes(a, b, opts);
     } else {
         std::cerr << "Error: Unknown mode '" << mode << "'\n";
         print_usage();
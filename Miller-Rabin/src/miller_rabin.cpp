@@ -1,12 +1,52 @@
 #include "miller_rabin.hpp"
+#include "factor.hpp"
+#include "montgomery.hpp"
+#include "trial_division.hpp"
 #include <random> // High-quality random number generation (Mersenne Twister)
+#include <atomic> // For the shared seed counter
 #include <cstdint> // For uint64_t
 #include <cstdlib> // For bool
+#include <cmath>   // For sqrtl in the perfect-square check
+#include <cstring> // For memset in the prime-generation window
+#include <vector>
 
-/* * GLOBAL RANDOM NUMBER GENERATOR
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h> // AVX-512 IFMA intrinsics for the batched path
+#define MR_HAVE_IFMA 1
+#endif
+
+/* * PER-THREAD RANDOM NUMBER GENERATOR
  * std::mt19937_64 is the 64-bit Mersenne Twister engine.
+ * thread_local gives every thread its own independently seeded engine,
+ * so witnesses can be drawn from several threads without a data race.
+ * After set_random_seed(), engines are seeded seed, seed + 1, ... in the
+ * order threads first draw, instead of from std::random_device. Which
+ * thread draws first depends on scheduling, so work split across threads
+ * calls seed_work_item() to tie its draws to the item instead.
  */
-static std::mt19937_64 rng(std::random_device{}());
+static std::atomic<uint64_t> seed_base(0);      // 0: seed from std::random_device
+static std::atomic<uint64_t> seeded_threads(0);
+
+static uint64_t initial_seed() {
+    uint64_t base = seed_base.load();
+    if (base == 0) return std::random_device{}();
+    return base + seeded_threads.fetch_add(1);
+}
+
+static thread_local std::mt19937_64 rng(initial_seed());
+
+void set_random_seed(uint64_t seed) {
+    seed_base.store(seed);
+    seeded_threads.store(1); // The calling thread takes 'seed' itself
+    rng.seed(seed != 0 ? seed : std::random_device{}());
+}
+
+void seed_work_item(uint64_t item) {
+    uint64_t base = seed_base.load();
+    if (base == 0) return;
+    // Spread consecutive items over the seed space (golden-ratio increment)
+    rng.seed(base ^ ((item + 1) * 0x9E3779B97F4A7C15ULL));
+}
 
 /*
  * Helper: Get a random number in range [min, max]
@@ -26,20 +66,10 @@ uint64_t get_random_range_public(uint64_t min, uint64_t max) {
 /*
  * Modular Exponentiation Implementation
  * CRITICAL: Uses `unsigned __int128` to prevent 64-bit overflow during multiplication.
+ * The loop lives in power_constexpr() so compile-time tables use the same code.
  */
 uint64_t power(uint64_t base, uint64_t exp, uint64_t mod) {
-    uint64_t res = 1;
-    base %= mod;
-    
-    while (exp > 0) {
-        if (exp % 2 == 1) {
-            // Cast to __int128 to perform safe multiplication
-            res = (uint64_t)((unsigned __int128)res * base % mod);
-        }
-        base = (uint64_t)((unsigned __int128)base * base % mod);
-        exp /= 2;
-    }
-    return res;
+    return power_constexpr(base, exp, mod);
 }
 
 /*
@@ -63,12 +93,631 @@ bool miller_rabin_single_round(uint64_t d, uint64_t n) {
     return false; // Composite
 }
 
+/*
+ * Single round of the Miller-Rabin test in Montgomery form.
+ * 'ctx' is shared by all rounds on the same n, so no division happens here.
+ */
+static bool miller_rabin_round_montgomery(const MontgomeryContext& ctx, uint64_t d, uint64_t a) {
+    uint64_t x = mont_power(ctx, mont_to(ctx, a), d);
+
+    if (x == ctx.one || x == ctx.minus_one)
+        return true;
+
+    while (d != ctx.n - 1) {
+        x = mont_mul(ctx, x, x);
+        d *= 2;
+
+        if (x == ctx.one)        return false;
+        if (x == ctx.minus_one)  return true;
+    }
+
+    return false; // Composite
+}
+
 /*
  * Main Miller-Rabin Wrapper
  */
 bool is_prime_miller_rabin(uint64_t n, int k) {
     if (n <= 1 || n == 4) return false;
     if (n <= 3) return true;
+    if (n % 2 == 0) return false; // Montgomery form needs an odd modulus
+
+    // Decompose n - 1 = 2^r * d
+    uint64_t d = n - 1;
+    while (d % 2 == 0) {
+        d /= 2;
+    }
+
+    // Built once, reused by all k rounds
+    MontgomeryContext ctx = mont_init(n);
+
+    for (int i = 0; i < k; i++) {
+        uint64_t a = get_random_range_internal(2, n - 2);
+        if (!miller_rabin_round_montgomery(ctx, d, a))
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * The witness table is checked at compile time: limits increase, and the
+ * classic strong pseudoprimes just past each smaller set are caught.
+ */
+static constexpr bool witness_limits_increase() {
+    for (size_t i = 1; i < sizeof(DETERMINISTIC_WITNESSES) / sizeof(WitnessSet); i++) {
+        if (DETERMINISTIC_WITNESSES[i].limit <= DETERMINISTIC_WITNESSES[i - 1].limit) return false;
+        if (DETERMINISTIC_WITNESSES[i].count > MAX_WITNESSES) return false;
+    }
+    return true;
+}
+static_assert(witness_limits_increase(), "witness sets must be sorted by limit");
+static_assert(!is_prime_v<2047> && !is_prime_v<1373653> && !is_prime_v<3215031751ULL>,
+              "strong pseudoprimes to the small bases must be rejected");
+static_assert(!is_prime_v<3825123056546413051ULL>, "spsp to the first 9 prime bases must be rejected");
+static_assert(is_prime_v<2147483647> && is_prime_v<18446744073709551557ULL>,
+              "known primes must be accepted");
+
+/*
+ * Helper: Smallest witness set that is exact for n
+ */
+static const WitnessSet* select_witnesses(uint64_t n) {
+    const WitnessSet* set = DETERMINISTIC_WITNESSES;
+    while (n >= set->limit && set->limit != UINT64_MAX) {
+        set++;
+    }
+    return set;
+}
+
+/*
+ * Deterministic Miller-Rabin Wrapper
+ */
+bool is_prime_deterministic(uint64_t n) {
+    if (n <= 1 || n == 4) return false;
+    if (n <= 3) return true;
+    if (n % 2 == 0) return false;
+
+    uint64_t d = n - 1;
+    while (d % 2 == 0) {
+        d /= 2;
+    }
+
+    const WitnessSet* set = select_witnesses(n);
+    MontgomeryContext ctx = mont_init(n);
+
+    for (int i = 0; i < set->count; i++) {
+        uint64_t a = set->bases[i] % n;
+        if (a == 0) continue; // Base is a multiple of n: says nothing
+        if (!miller_rabin_round_montgomery(ctx, d, a))
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Single fixed-base round (strong probable-prime test)
+ */
+bool is_strong_probable_prime(uint64_t n, uint64_t base) {
+    if (n <= 3) return n >= 2;
+    if (n % 2 == 0) return false;
+
+    uint64_t a = base % n;
+    if (a == 0) return true; // Base is a multiple of n: says nothing
+
+    uint64_t d = n - 1;
+    while (d % 2 == 0) {
+        d /= 2;
+    }
+    return miller_rabin_round_montgomery(mont_init(n), d, a);
+}
+
+/* ===================== Strong-liar counting ===================== */
+
+static uint64_t gcd_u64(uint64_t a, uint64_t b) {
+    while (b != 0) {
+        uint64_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Largest odd divisor of x, and the exponent of 2 that was removed
+static uint64_t odd_part(uint64_t x, int* twos) {
+    int s = 0;
+    while (x % 2 == 0) {
+        x /= 2;
+        s++;
+    }
+    if (twos) *twos = s;
+    return x;
+}
+
+/*
+ * Strong-liar count (Monier 1980). For odd n = p_1^e_1 ... p_w^e_w with
+ * n - 1 = 2^s * d (d odd) and nu = min v2(p_i - 1), the number of bases in
+ * [1, n - 1] for which n is a strong probable prime is
+ *     (1 + (2^(w * nu) - 1) / (2^w - 1)) * prod gcd(d, odd part of p_i - 1).
+ * Only the distinct primes of n matter; factor() finds them with Pollard-Brent,
+ * so a 64-bit semiprime no longer costs sqrt(n) trial divisions.
+ */
+uint64_t count_strong_liars(uint64_t n) {
+    if (n < 5) return 0;
+    if (n % 2 == 0) return 0; // Even n is always rejected
+    if (is_prime_deterministic(n)) return n - 3; // Every base "lies"
+
+    uint64_t d = odd_part(n - 1, nullptr);
+
+    int w = 0, nu = 64;
+    unsigned __int128 gcd_product = 1;
+    std::vector<uint64_t> primes = factor(n); // Ascending, so repeats are adjacent
+    for (size_t i = 0; i < primes.size(); i++) {
+        if (i > 0 && primes[i] == primes[i - 1]) continue;
+        int twos;
+        gcd_product *= gcd_u64(d, odd_part(primes[i] - 1, &twos));
+        if (twos < nu) nu = twos;
+        w++;
+    }
+
+    // (2^(w * nu) - 1) / (2^w - 1) = sum of 2^(w * j) for j < nu
+    unsigned __int128 series = 0;
+    for (int j = 0; j < nu; j++) {
+        series += (unsigned __int128)1 << (w * j);
+    }
+
+    unsigned __int128 liars = (1 + series) * gcd_product;
+    return (uint64_t)liars - 2; // Drop the trivial liars 1 and n - 1
+}
+
+/* ===================== Baillie-PSW ===================== */
+
+/*
+ * Jacobi symbol (a / n) for odd n > 0.
+ */
+static int jacobi(uint64_t a, uint64_t n) {
+    a %= n;
+    int result = 1;
+    while (a != 0) {
+        while (a % 2 == 0) {
+            a /= 2;
+            uint64_t r = n % 8;
+            if (r == 3 || r == 5) result = -result;
+        }
+        uint64_t t = a; a = n; n = t; // Quadratic reciprocity
+        if (a % 4 == 3 && n % 4 == 3) result = -result;
+        a %= n;
+    }
+    return n == 1 ? result : 0;
+}
+
+static bool is_perfect_square(uint64_t n) {
+    uint64_t r = (uint64_t)sqrtl((long double)n);
+    if (r > 0xFFFFFFFFULL) r = 0xFFFFFFFFULL; // Keep r * r from overflowing
+    while (r * r > n) r--;
+    while (r < 0xFFFFFFFFULL && (r + 1) * (r + 1) <= n) r++;
+    return r * r == n;
+}
+
+/*
+ * Helpers: modular add/sub/halve for values already reduced mod n.
+ * They work on Montgomery-form values too, since all three are linear.
+ */
+static inline uint64_t mod_add(uint64_t a, uint64_t b, uint64_t n) {
+    uint64_t s = a + b;
+    return (s < a || s >= n) ? s - n : s;
+}
+
+static inline uint64_t mod_sub(uint64_t a, uint64_t b, uint64_t n) {
+    return a >= b ? a - b : a - b + n;
+}
+
+static inline uint64_t mod_half(uint64_t a, uint64_t n) {
+    // (a + n) / 2 without overflowing when a is odd (n is odd)
+    return (a & 1) ? (a >> 1) + (n >> 1) + 1 : a >> 1;
+}
+
+/*
+ * Strong Lucas probable-prime test with Selfridge's parameters:
+ * D is the first of 5, -7, 9, -11, ... with (D / n) = -1, P = 1, Q = (1 - D) / 4.
+ * n must be odd, > 3, with no small factors.
+ * The sequences run in Montgomery form, reusing the context from the base-2 round.
+ */
+static bool strong_lucas_test(const MontgomeryContext& ctx) {
+    uint64_t n = ctx.n;
+
+    int64_t D = 5;
+    for (int tries = 0; ; tries++) {
+        uint64_t d_mod = D > 0 ? (uint64_t)D % n : n - (uint64_t)(-D) % n;
+        int j = jacobi(d_mod, n);
+        if (j == -1) break;
+        if (j == 0 && d_mod != 0) return false; // gcd(D, n) is a factor
+        // Squares never give -1, so check once instead of searching forever
+        if (tries == 8 && is_perfect_square(n)) return false;
+        D = D > 0 ? -(D + 2) : -D + 2;
+    }
+
+    int64_t Q = (1 - D) / 4;
+    uint64_t q_mod = Q >= 0 ? (uint64_t)Q % n : n - (uint64_t)(-Q) % n;
+    uint64_t d_mod = D > 0 ? (uint64_t)D % n : n - (uint64_t)(-D) % n;
+
+    uint64_t mq = mont_to(ctx, q_mod);
+    uint64_t md = mont_to(ctx, d_mod);
+
+    // n + 1 = 2^s * d (n + 1 cannot overflow: n has no factor of 3)
+    uint64_t d = n + 1;
+    int s = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        s++;
+    }
+
+    // U_1 = 1, V_1 = P = 1, Q^1 = Q; walk the remaining bits of d from the top
+    uint64_t U = ctx.one, V = ctx.one, Qk = mq;
+    for (int bit = 62 - __builtin_clzll(d); bit >= 0; bit--) {
+        // Double: U_2k = U_k V_k, V_2k = V_k^2 - 2 Q^k
+        U = mont_mul(ctx, U, V);
+        V = mod_sub(mont_mul(ctx, V, V), mod_add(Qk, Qk, n), n);
+        Qk = mont_mul(ctx, Qk, Qk);
+
+        if ((d >> bit) & 1) {
+            // Step: U_k+1 = (P U_k + V_k) / 2, V_k+1 = (D U_k + P V_k) / 2
+            uint64_t u_next = mod_half(mod_add(U, V, n), n);
+            V = mod_half(mod_add(mont_mul(ctx, md, U), V, n), n);
+            U = u_next;
+            Qk = mont_mul(ctx, Qk, mq);
+        }
+    }
+
+    if (U == 0 || V == 0) return true;
+
+    for (int r = 1; r < s; r++) {
+        V = mod_sub(mont_mul(ctx, V, V), mod_add(Qk, Qk, n), n);
+        if (V == 0) return true;
+        Qk = mont_mul(ctx, Qk, Qk);
+    }
+
+    return false; // Composite
+}
+
+/*
+ * Baillie-PSW Wrapper
+ */
+bool is_prime_bpsw(uint64_t n) {
+    // Small-prime filter settles small n and most composites
+    PrefilterResult pre = small_prime_prefilter(n);
+    if (pre != PREFILTER_UNKNOWN) return pre == PREFILTER_PRIME;
+
+    uint64_t d = n - 1;
+    while (d % 2 == 0) {
+        d /= 2;
+    }
+
+    MontgomeryContext ctx = mont_init(n);
+
+    if (!miller_rabin_round_montgomery(ctx, d, 2))
+        return false;
+
+    return strong_lucas_test(ctx);
+}
+
+/* ===================== Batched primality ===================== */
+
+/*
+ * Per-candidate state for the batched paths.
+ * Each lane carries its own modulus, decomposition and witness set.
+ */
+struct BatchLane {
+    uint64_t n;
+    uint64_t d;  // n - 1 = 2^s * d
+    int s;
+    const WitnessSet* set;
+};
+
+static BatchLane make_lane(uint64_t n) {
+    BatchLane lane;
+    lane.n = n;
+    lane.d = n - 1;
+    lane.s = 0;
+    while (lane.d % 2 == 0) {
+        lane.d /= 2;
+        lane.s++;
+    }
+    lane.set = select_witnesses(n);
+    return lane;
+}
+
+// Filler for partially used groups: 5 is prime and needs a single round
+static const uint64_t BATCH_PAD = 5;
+
+/*
+ * Interleaved scalar path: SCALAR_LANES independent exponentiations run in
+ * lock-step so the CPU can overlap their multiply latencies.
+ */
+static const int SCALAR_LANES = 4;
+
+static void batch_group_scalar(const uint64_t* nums, const size_t* idx, int used, uint8_t* out,
+                               int first_round, int last_round) {
+    BatchLane lane[SCALAR_LANES];
+    MontgomeryContext ctx[SCALAR_LANES];
+    bool prime[SCALAR_LANES];
+    int max_rounds = 0;
+
+    for (int l = 0; l < SCALAR_LANES; l++) {
+        lane[l] = make_lane(l < used ? nums[idx[l]] : BATCH_PAD);
+        ctx[l] = mont_init(lane[l].n);
+        prime[l] = true;
+        if (lane[l].set->count > max_rounds) max_rounds = lane[l].set->count;
+    }
+    if (last_round < max_rounds) max_rounds = last_round;
+
+    for (int j = first_round; j < max_rounds; j++) {
+        uint64_t x[SCALAR_LANES], b[SCALAR_LANES], e[SCALAR_LANES];
+        bool active[SCALAR_LANES], pass[SCALAR_LANES];
+        int max_s = 0;
+
+        for (int l = 0; l < SCALAR_LANES; l++) {
+            uint64_t a = j < lane[l].set->count ? lane[l].set->bases[j] % lane[l].n : 0;
+            active[l] = prime[l] && a != 0;
+            b[l] = active[l] ? mont_to(ctx[l], a) : ctx[l].one;
+            e[l] = active[l] ? lane[l].d : 0;
+            x[l] = ctx[l].one;
+        }
+
+        // x = a^d for all lanes at once
+        while ((e[0] | e[1] | e[2] | e[3]) != 0) {
+            for (int l = 0; l < SCALAR_LANES; l++) {
+                uint64_t m = mont_mul(ctx[l], x[l], b[l]);
+                x[l] = (e[l] & 1) ? m : x[l];
+                b[l] = mont_mul(ctx[l], b[l], b[l]);
+                e[l] >>= 1;
+            }
+        }
+
+        for (int l = 0; l < SCALAR_LANES; l++) {
+            pass[l] = !active[l] || x[l] == ctx[l].one || x[l] == ctx[l].minus_one;
+            if (!pass[l] && lane[l].s > max_s) max_s = lane[l].s;
+        }
+
+        // Squaring chain: look for n - 1 within s - 1 squarings
+        for (int r = 1; r < max_s; r++) {
+            for (int l = 0; l < SCALAR_LANES; l++) {
+                if (!pass[l] && r < lane[l].s) {
+                    x[l] = mont_mul(ctx[l], x[l], x[l]);
+                    if (x[l] == ctx[l].minus_one) pass[l] = true;
+                }
+            }
+        }
+
+        for (int l = 0; l < SCALAR_LANES; l++) {
+            if (!pass[l]) prime[l] = false;
+        }
+    }
+
+    for (int l = 0; l < used; l++) {
+        out[idx[l]] = prime[l] ? 1 : 0;
+    }
+}
+
+#ifdef MR_HAVE_IFMA
+/*
+ * AVX-512 IFMA path: 8 moduli below 2^52 per vector, Montgomery radix 2^52.
+ * AVX2/AVX-512F have no 64x64->128 multiply, but IFMA's 52-bit
+ * multiply-add gives exactly the two halves REDC needs.
+ */
+static const int IFMA_LANES = 8;
+static const uint64_t IFMA_LIMIT = 1ULL << 52;
+static const uint64_t MASK52 = IFMA_LIMIT - 1;
+
+__attribute__((target("avx512f,avx512ifma")))
+static inline __m512i ifma_mont_mul(__m512i a, __m512i b, __m512i n, __m512i n_neg_inv) {
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i lo = _mm512_madd52lo_epu64(zero, a, b);
+    __m512i hi = _mm512_madd52hi_epu64(zero, a, b);
+    __m512i m = _mm512_madd52lo_epu64(zero, lo, n_neg_inv);
+    // lo + low52(m*n) is 0 or exactly 2^52; its bit 52 is the carry
+    __m512i carry = _mm512_srli_epi64(_mm512_madd52lo_epu64(lo, m, n), 52);
+    __m512i res = _mm512_madd52hi_epu64(_mm512_add_epi64(hi, carry), m, n);
+    // res < 2n: subtract n once if needed
+    return _mm512_min_epu64(res, _mm512_sub_epi64(res, n));
+}
+
+__attribute__((target("avx512f,avx512ifma")))
+static void batch_group_ifma(const uint64_t* nums, const size_t* idx, int used, uint8_t* out,
+                             int first_round, int last_round) {
+    alignas(64) uint64_t n[IFMA_LANES], ninv[IFMA_LANES], one[IFMA_LANES];
+    alignas(64) uint64_t mone[IFMA_LANES], r2[IFMA_LANES], d[IFMA_LANES], s[IFMA_LANES];
+    alignas(64) uint64_t a[IFMA_LANES];
+    const WitnessSet* sets[IFMA_LANES];
+    int max_rounds = 0;
+
+    for (int l = 0; l < IFMA_LANES; l++) {
+        BatchLane lane = make_lane(l < used ? nums[idx[l]] : BATCH_PAD);
+        uint64_t inv = lane.n;
+        for (int i = 0; i < 5; i++) inv *= 2 - lane.n * inv;
+        uint64_t r = IFMA_LIMIT % lane.n; // 2^52 mod n
+
+        n[l] = lane.n;
+        ninv[l] = (0 - inv) & MASK52;
+        one[l] = r;
+        mone[l] = lane.n - r;
+        r2[l] = (uint64_t)((unsigned __int128)r * r % lane.n);
+        d[l] = lane.d;
+        s[l] = (uint64_t)lane.s;
+        sets[l] = lane.set;
+        if (lane.set->count > max_rounds) max_rounds = lane.set->count;
+    }
+    if (last_round < max_rounds) max_rounds = last_round;
+
+    const __m512i N = _mm512_load_si512(n);
+    const __m512i NINV = _mm512_load_si512(ninv);
+    const __m512i ONE = _mm512_load_si512(one);
+    const __m512i MONE = _mm512_load_si512(mone);
+    const __m512i R2 = _mm512_load_si512(r2);
+    const __m512i D = _mm512_load_si512(d);
+    const __m512i S = _mm512_load_si512(s);
+    const __m512i LOW_BIT = _mm512_set1_epi64(1);
+    __mmask8 prime = 0xFF;
+
+    for (int j = first_round; j < max_rounds && prime; j++) {
+        int max_s = 0;
+        for (int l = 0; l < IFMA_LANES; l++) {
+            a[l] = j < sets[l]->count ? sets[l]->bases[j] % n[l] : 0;
+            if (a[l] != 0 && (int)s[l] > max_s) max_s = (int)s[l];
+        }
+        __m512i A = _mm512_load_si512(a);
+        __mmask8 active = prime & _mm512_test_epi64_mask(A, A);
+
+        __m512i B = ifma_mont_mul(A, R2, N, NINV);
+        __m512i X = ONE;
+        __m512i E = _mm512_maskz_mov_epi64(active, D);
+
+        while (_mm512_test_epi64_mask(E, E)) {
+            __m512i M = ifma_mont_mul(X, B, N, NINV);
+            X = _mm512_mask_mov_epi64(X, _mm512_test_epi64_mask(E, LOW_BIT), M);
+            B = ifma_mont_mul(B, B, N, NINV);
+            E = _mm512_srli_epi64(E, 1);
+        }
+
+        __mmask8 pass = (__mmask8)(~active | _mm512_cmpeq_epu64_mask(X, ONE) |
+                                   _mm512_cmpeq_epu64_mask(X, MONE));
+
+        for (int r = 1; r < max_s; r++) {
+            __mmask8 pending = (__mmask8)(~pass & _mm512_cmpgt_epu64_mask(S, _mm512_set1_epi64(r)));
+            if (!pending) break;
+            X = ifma_mont_mul(X, X, N, NINV);
+            pass |= pending & _mm512_cmpeq_epu64_mask(X, MONE);
+        }
+
+        prime &= pass;
+    }
+
+    for (int l = 0; l < used; l++) {
+        out[idx[l]] = (prime >> l) & 1;
+    }
+}
+#endif
+
+/*
+ * Runs witness rounds [first_round, last_round) on the candidates in idx,
+ * routing each one to the IFMA or the interleaved scalar lanes.
+ */
+static void batch_run_rounds(const uint64_t* nums, const size_t* idx, size_t count, uint8_t* out,
+                             int first_round, int last_round) {
+#ifdef MR_HAVE_IFMA
+    static const bool use_ifma = __builtin_cpu_supports("avx512ifma");
+    size_t small_idx[IFMA_LANES];
+    int small_used = 0;
+#endif
+    size_t big_idx[SCALAR_LANES];
+    int big_used = 0;
+
+    for (size_t i = 0; i < count; i++) {
+#ifdef MR_HAVE_IFMA
+        if (use_ifma && nums[idx[i]] < IFMA_LIMIT) {
+            small_idx[small_used++] = idx[i];
+            if (small_used == IFMA_LANES) {
+                batch_group_ifma(nums, small_idx, small_used, out, first_round, last_round);
+                small_used = 0;
+            }
+            continue;
+        }
+#endif
+        big_idx[big_used++] = idx[i];
+        if (big_used == SCALAR_LANES) {
+            batch_group_scalar(nums, big_idx, big_used, out, first_round, last_round);
+            big_used = 0;
+        }
+    }
+
+    // Flush partially filled groups
+#ifdef MR_HAVE_IFMA
+    if (small_used > 0) batch_group_ifma(nums, small_idx, small_used, out, first_round, last_round);
+#endif
+    if (big_used > 0) batch_group_scalar(nums, big_idx, big_used, out, first_round, last_round);
+}
+
+// Candidates are processed in chunks small enough to keep the index lists on the stack
+static const size_t BATCH_CHUNK = 512;
+
+/*
+ * Batched deterministic primality test
+ * The small-prime prefilter settles most composites without any modexp.
+ * Stage 1 runs the first witness on every survivor, which rejects almost
+ * all remaining composites. Stage 2 regroups what is left so the remaining
+ * rounds do not keep lanes busy on numbers that are already known composite.
+ */
+void is_prime_batch(const uint64_t* nums, size_t count, uint8_t* out, PrefilterStats* stats) {
+    size_t pending[BATCH_CHUNK];
+
+    for (size_t start = 0; start < count; start += BATCH_CHUNK) {
+        size_t end = count - start < BATCH_CHUNK ? count : start + BATCH_CHUNK;
+        size_t used = 0;
+
+        for (size_t i = start; i < end; i++) {
+            // Candidates the prefilter settles never reach a lane
+            PrefilterResult pre = small_prime_prefilter(nums[i]);
+            if (pre == PREFILTER_UNKNOWN) {
+                pending[used++] = i;
+            } else {
+                out[i] = pre == PREFILTER_PRIME ? 1 : 0;
+                if (stats) {
+                    if (pre == PREFILTER_PRIME) stats->prefilter_prime++;
+                    else                        stats->prefilter_composite++;
+                }
+            }
+        }
+
+        batch_run_rounds(nums, pending, used, out, 0, 1);
+
+        size_t survivors = 0, settled_prime = 0;
+        for (size_t i = 0; i < used; i++) {
+            if (!out[pending[i]]) continue;
+            if (select_witnesses(nums[pending[i]])->count > 1) {
+                pending[survivors++] = pending[i];
+            } else {
+                settled_prime++; // Single-base witness set: stage 1 was exact
+            }
+        }
+
+        batch_run_rounds(nums, pending, survivors, out, 1, MAX_WITNESSES);
+
+        if (stats) {
+            size_t mr_primes = settled_prime;
+            for (size_t i = 0; i < survivors; i++) {
+                mr_primes += out[pending[i]];
+            }
+            stats->tested += end - start;
+            stats->mr_prime += mr_primes;
+            stats->mr_composite += used - mr_primes;
+        }
+    }
+}
+
+/*
+ * Prefiltered Miller-Rabin Wrapper
+ */
+bool is_prime_prefiltered(uint64_t n, int k, PrefilterStats* stats) {
+    PrefilterResult pre = small_prime_prefilter(n);
+    bool prime = pre == PREFILTER_PRIME ||
+                 (pre == PREFILTER_UNKNOWN && is_prime_miller_rabin(n, k));
+
+    if (stats) {
+        stats->tested++;
+        if (pre == PREFILTER_COMPOSITE)     stats->prefilter_composite++;
+        else if (pre == PREFILTER_PRIME)    stats->prefilter_prime++;
+        else if (prime)                     stats->mr_prime++;
+        else                                stats->mr_composite++;
+    }
+    return prime;
+}
+
+/*
+ * Division-based Miller-Rabin Wrapper (reference path for benchmarks)
+ */
+bool is_prime_miller_rabin_classic(uint64_t n, int k) {
+    if (n <= 1 || n == 4) return false;
+    if (n <= 3) return true;
     
     // Decompose n - 1 = 2^r * d
     uint64_t d = n - 1;
@@ -83,4 +732,131 @@ bool is_prime_miller_rabin(uint64_t n, int k) {
     }
     
     return true; 
-}
\ No newline at end of file
+}
+/* ===================== Prime generation ===================== */
+
+// Odd primes available to the sieve (3 .. 727), and the window length in odd candidates
+static const int GEN_SIEVE_PRIMES = 128;
+static const uint32_t GEN_WINDOW = 64;
+
+struct GenSievePrimes {
+    uint32_t p[GEN_SIEVE_PRIMES];
+    uint64_t magic[GEN_SIEVE_PRIMES];   // 2^64 / p rounded up, for mod_p() without a divide
+    uint32_t two32_mod[GEN_SIEVE_PRIMES]; // 2^32 mod p
+
+    constexpr GenSievePrimes() : p(), magic(), two32_mod() {
+        int count = 0;
+        for (uint32_t i = 3; count < GEN_SIEVE_PRIMES; i += 2) {
+            if (!trial_division_constexpr(i)) continue;
+            p[count] = i;
+            magic[count] = UINT64_MAX / i + 1;
+            two32_mod[count] = (uint32_t)((1ULL << 32) % i);
+            count++;
+        }
+    }
+
+    // x mod p[j] for 32-bit x: the low 64 bits of magic * x are the fraction x / p
+    uint32_t mod_p(int j, uint32_t x) const {
+        uint64_t fraction = magic[j] * x;
+        return (uint32_t)(((unsigned __int128)fraction * p[j]) >> 64);
+    }
+
+    // n mod p[j] from the two 32-bit halves of n
+    uint32_t mod_p(int j, uint64_t n) const {
+        uint32_t hi = mod_p(j, (uint32_t)(n >> 32)) * two32_mod[j];
+        return mod_p(j, hi + mod_p(j, (uint32_t)n));
+    }
+};
+
+// Built by the compiler; the 128th odd prime must be 727 as the comment above says
+static constexpr GenSievePrimes GEN_SIEVE_TABLE;
+static_assert(GEN_SIEVE_TABLE.p[GEN_SIEVE_PRIMES - 1] == 727, "unexpected sieve prime table");
+
+static const GenSievePrimes& gen_sieve_primes() {
+    return GEN_SIEVE_TABLE;
+}
+
+/*
+ * Sieve window over the odd candidates base, base + 2, ..., base + 2 * (GEN_WINDOW - 1).
+ * Each small prime remembers the index of its next odd multiple, so moving
+ * to the following window costs one subtraction per prime. The starting
+ * residues are computed once, with multiplications instead of divides.
+ */
+struct PrimeSearchWindow {
+    uint64_t base;
+    int primes; // How many of the table's primes this search sieves with
+    uint32_t next[GEN_SIEVE_PRIMES];
+    uint8_t composite[GEN_WINDOW];
+
+    PrimeSearchWindow(uint64_t odd_base, int sieve_primes) : base(odd_base), primes(sieve_primes) {
+        const GenSievePrimes& table = gen_sieve_primes();
+        for (int j = 0; j < primes; j++) {
+            uint64_t p = table.p[j];
+            if (base <= p) {
+                // p itself is a candidate: start at p^2, possibly past this window
+                next[j] = (uint32_t)((p * p - base) / 2);
+            } else {
+                // base + 2i = 0 (mod p)  <=>  i = -base * 2^-1 (mod p)
+                uint32_t r = table.mod_p(j, base);
+                next[j] = table.mod_p(j, (uint32_t)((r == 0 ? 0 : p - r) * ((p + 1) / 2)));
+            }
+        }
+        sieve();
+    }
+
+    void sieve() {
+        const GenSievePrimes& table = gen_sieve_primes();
+        memset(composite, 0, sizeof(composite));
+        for (int j = 0; j < primes; j++) {
+            uint32_t i = next[j];
+            for (; i < GEN_WINDOW; i += table.p[j]) composite[i] = 1;
+            next[j] = i - GEN_WINDOW;
+        }
+    }
+
+    void advance() {
+        base += 2 * (uint64_t)GEN_WINDOW;
+        sieve();
+    }
+};
+
+/*
+ * Helper: Smallest prime in [odd_start, limit], or 0 if there is none.
+ * Only candidates the window leaves unmarked reach the deterministic test.
+ */
+static uint64_t first_prime_from(uint64_t odd_start, uint64_t limit) {
+    // Each sieve prime costs a few ns per search and saves a test on 1/p of the
+    // candidates; gaps and test cost both grow with the size, so does the
+    // break-even prime (~2 primes per bit measured, i.e. all 128 at 64 bits)
+    int bits = 64 - __builtin_clzll(odd_start);
+    PrimeSearchWindow window(odd_start, 2 * bits < GEN_SIEVE_PRIMES ? 2 * bits : GEN_SIEVE_PRIMES);
+    for (;;) {
+        for (uint32_t i = 0; i < GEN_WINDOW; i++) {
+            if (window.composite[i]) continue;
+            if (2 * (uint64_t)i > limit - window.base) return 0;
+            uint64_t candidate = window.base + 2 * (uint64_t)i;
+            if (is_prime_deterministic(candidate)) return candidate;
+        }
+        // Stop before the next window would run past the limit (or wrap around 2^64)
+        if (limit - window.base < 2 * (uint64_t)GEN_WINDOW) return 0;
+        window.advance();
+    }
+}
+
+uint64_t next_prime(uint64_t n) {
+    if (n < 2) return 2;
+    if (n == UINT64_MAX) return 0;
+    return first_prime_from((n + 1) | 1, UINT64_MAX);
+}
+
+uint64_t random_prime(int bits) {
+    if (bits < 2 || bits > 64) return 0;
+    if (bits == 2) return get_random_range_internal(2, 3);
+
+    uint64_t lo = 1ULL << (bits - 1);
+    uint64_t hi = bits == 64 ? UINT64_MAX : (1ULL << bits) - 1;
+    uint64_t prime = first_prime_from(get_random_range_internal(lo, hi) | 1, hi);
+
+    // Ran off the top of the range: wrap around to its bottom
+    return prime ? prime : first_prime_from(lo + 1, hi);
+}
@@ -3,6 +3,22 @@
 
 #include <cstdint> // Provides uint64_t and standard integer types
 #include <cstdlib> // For 'bool' type, though cstdint is often sufficient
+#include <cstddef> // For size_t
+#include "bigint.hpp" // Multi-limb integers for the templated overload
+
+/**
+ * Makes the random witnesses reproducible: the calling thread is reseeded
+ * with 'seed' and threads that draw later get seed + 1, seed + 2, ...
+ * A seed of 0 goes back to seeding from std::random_device.
+ */
+void set_random_seed(uint64_t seed);
+
+/**
+ * After set_random_seed() with a nonzero seed, reseeds the calling thread
+ * from (seed, item), so work item 'item' draws the same witnesses whichever
+ * thread runs it and however many threads there are. Does nothing otherwise.
+ */
+void seed_work_item(uint64_t item);
 
 /**
  * Modular Exponentiation: Calculates (base^exp) % mod efficiently.
@@ -13,15 +29,271 @@ uint64_t power(uint64_t base, uint64_t exp, uint64_t mod);
 
 /**
  * Main Miller-Rabin Primality Test wrapper.
+ * Builds a Montgomery context once per n and runs every round in Montgomery form.
  * @param n The number to test.
  * @param k The number of iterations (witnesses). Higher k reduces the error rate.
  * @return true if 'n' is probably prime, false if definitely composite.
  */
 bool is_prime_miller_rabin(uint64_t n, int k);
 
+/**
+ * Deterministic Miller-Rabin for the whole uint64_t range.
+ * Uses a fixed witness set chosen by the size of n (at most 7 bases),
+ * so the answer is exact and no random numbers are drawn.
+ * @return true if 'n' is prime, false otherwise.
+ */
+bool is_prime_deterministic(uint64_t n);
+
+/**
+ * Fixed witness sets that make Miller-Rabin exact below 'limit'.
+ * Sets come from Jaeschke (1993) and Sinclair's 7-base set for all of 2^64.
+ * Checked in order, so small n stop after one or two rounds.
+ * Shared by the run-time and the compile-time deterministic tests.
+ */
+const int MAX_WITNESSES = 7;
+
+struct WitnessSet {
+    uint64_t limit;
+    int count;
+    uint64_t bases[MAX_WITNESSES];
+};
+
+inline constexpr WitnessSet DETERMINISTIC_WITNESSES[] = {
+    { 2047ULL,             1, {2} },
+    { 1373653ULL,          2, {2, 3} },
+    { 9080191ULL,          2, {31, 73} },
+    { 4759123141ULL,       3, {2, 7, 61} },
+    { 1122004669633ULL,    4, {2, 13, 23, 1662803} },
+    { 2152302898747ULL,    5, {2, 3, 5, 7, 11} },
+    { 3474749660383ULL,    6, {2, 3, 5, 7, 11, 13} },
+    { 341550071728321ULL,  7, {2, 3, 5, 7, 11, 13, 17} },
+    { UINT64_MAX,          7, {2, 325, 9375, 28178, 450775, 9780504, 1795265022} },
+};
+
+/**
+ * Compile-time modular exponentiation: the same square-and-multiply as
+ * power() (which is defined through it), usable in constant expressions.
+ */
+constexpr uint64_t power_constexpr(uint64_t base, uint64_t exp, uint64_t mod) {
+    uint64_t res = 1;
+    base %= mod;
+    while (exp > 0) {
+        if (exp % 2 == 1) res = (uint64_t)((unsigned __int128)res * base % mod);
+        base = (uint64_t)((unsigned __int128)base * base % mod);
+        exp /= 2;
+    }
+    return res;
+}
+
+/**
+ * Compile-time deterministic Miller-Rabin over DETERMINISTIC_WITNESSES, for
+ * building tables and checking them with static_assert. Reduces with 128-bit
+ * remainders, so at run time is_prime_deterministic() is the faster choice.
+ */
+constexpr bool is_prime_deterministic_constexpr(uint64_t n) {
+    if (n <= 1 || n == 4) return false;
+    if (n <= 3) return true;
+    if (n % 2 == 0) return false;
+
+    uint64_t d = n - 1;
+    int s = 0;
+    while (d % 2 == 0) {
+        d /= 2;
+        s++;
+    }
+
+    const WitnessSet* set = DETERMINISTIC_WITNESSES;
+    while (n >= set->limit && set->limit != UINT64_MAX) {
+        set++;
+    }
+
+    for (int i = 0; i < set->count; i++) {
+        uint64_t a = set->bases[i] % n;
+        if (a == 0) continue; // Base is a multiple of n: says nothing
+        uint64_t x = power_constexpr(a, d, n);
+        if (x == 1 || x == n - 1) continue;
+
+        bool witness = true;
+        for (int r = 1; r < s && witness; r++) {
+            x = (uint64_t)((unsigned __int128)x * x % n);
+            if (x == n - 1) witness = false;
+        }
+        if (witness) return false;
+    }
+    return true;
+}
+
+/**
+ * is_prime_v<N>: primality of N as a compile-time constant.
+ */
+template <uint64_t N>
+constexpr bool is_prime_v = is_prime_deterministic_constexpr(N);
+
+/**
+ * One Miller-Rabin round with a fixed base: true if 'n' is a strong
+ * probable prime to 'base'. Odd composites that pass for base 2 are the
+ * base-2 strong pseudoprimes. A base that is a multiple of n proves
+ * nothing, so the answer is then true.
+ */
+bool is_strong_probable_prime(uint64_t n, uint64_t base);
+
+/**
+ * Exact number of strong liars for n: bases a in [2, n - 2] for which a
+ * Miller-Rabin round wrongly reports "probably prime". The random rounds
+ * draw a uniformly from that range, so one round fails to catch an odd
+ * composite n with probability count_strong_liars(n) / (n - 3).
+ * Uses Monier's formula, so the cost is one factorisation, not n rounds.
+ * Returns n - 3 for primes and 0 for even n or n < 5.
+ */
+uint64_t count_strong_liars(uint64_t n);
+
+/**
+ * Baillie-PSW test: a base-2 strong probable-prime round followed by a
+ * strong Lucas test (Selfridge parameters). No composite below 2^64 passes
+ * both, so the answer is exact for every uint64_t, and the cost is fixed
+ * (about three Miller-Rabin rounds) instead of growing with k.
+ * @return true if 'n' is prime, false otherwise.
+ */
+bool is_prime_bpsw(uint64_t n);
+
+/**
+ * Per-stage counters for the prefiltered tests.
+ * Every tested candidate lands in exactly one of the four buckets.
+ */
+struct PrefilterStats {
+    uint64_t tested = 0;
+    uint64_t prefilter_composite = 0; // Rejected by the small-prime filter
+    uint64_t prefilter_prime = 0;     // Proven prime by the small-prime filter
+    uint64_t mr_composite = 0;        // Survived the filter, rejected by Miller-Rabin
+    uint64_t mr_prime = 0;            // Survived the filter, accepted by Miller-Rabin
+
+    void merge(const PrefilterStats& other) {
+        tested += other.tested;
+        prefilter_composite += other.prefilter_composite;
+        prefilter_prime += other.prefilter_prime;
+        mr_composite += other.mr_composite;
+        mr_prime += other.mr_prime;
+    }
+};
+
+/**
+ * Miller-Rabin behind the small-prime prefilter.
+ * Only candidates with no small factor pay for the k modexp rounds.
+ * @param stats Optional; counts which stage decided 'n'.
+ */
+bool is_prime_prefiltered(uint64_t n, int k, PrefilterStats* stats = nullptr);
+
+/**
+ * Batched deterministic primality test for many independent candidates.
+ * Candidates first go through the small-prime prefilter; survivors run
+ * several exponentiations in lock-step so their multiply latencies
+ * overlap. Survivors below 2^52 use 8-lane AVX-512 IFMA when the CPU has it.
+ * @param nums  Input candidates.
+ * @param count Number of candidates.
+ * @param out   out[i] is set to 1 if nums[i] is prime, 0 otherwise.
+ * @param stats Optional; counts which stage decided each candidate.
+ */
+void is_prime_batch(const uint64_t* nums, size_t count, uint8_t* out,
+                    PrefilterStats* stats = nullptr);
+
+/**
+ * Miller-Rabin using the division-based power() for every multiplication.
+ * Same contract as is_prime_miller_rabin(); kept as the "before" reference
+ * for the Montgomery benchmarks.
+ */
+bool is_prime_miller_rabin_classic(uint64_t n, int k);
+
 /**
  * Generates a random number in the range [min, max].
  */
 uint64_t get_random_range_public(uint64_t min, uint64_t max);
 
+/**
+ * Smallest prime strictly greater than n, or 0 if there is none below 2^64
+ * (n >= 18446744073709551557). Candidates are walked through a sieve window
+ * that strikes out multiples of small odd primes (up to 128 of them, more
+ * for larger n) ahead of the cursor, so only the survivors pay for a
+ * deterministic Miller-Rabin test.
+ */
+uint64_t next_prime(uint64_t n);
+
+/**
+ * Random prime with exactly 'bits' bits (2 <= bits <= 64), or 0 if 'bits'
+ * is out of range. Takes the first prime at or after a uniform random start,
+ * so primes after long gaps are somewhat more likely; that is fine for table
+ * sizing and test data, not for keys. Uses the calling thread's generator,
+ * so set_random_seed() makes it reproducible.
+ */
+uint64_t random_prime(int bits);
+
+/**
+ * Multi-precision Miller-Rabin for Bits-wide candidates (Bits a multiple of 64),
+ * e.g. is_prime_miller_rabin_mp<2048>(n, k) for key generation.
+ * Runs on a Montgomery context with sliding-window exponentiation and
+ * rejects multiples of small primes before any modexp.
+ * @param n The number to test.
+ * @param k The number of random witnesses.
+ * @return true if 'n' is probably prime, false if definitely composite.
+ */
+template <size_t Bits>
+bool is_prime_miller_rabin_mp(const BigUInt<Bits / 64>& n, int k) {
+    static_assert(Bits % 64 == 0 && Bits >= 128, "Bits must be a multiple of 64, at least 128");
+    typedef BigUInt<Bits / 64> Num;
+    const size_t Limbs = Bits / 64;
+
+    // Small values fit the 64-bit path
+    bool small = true;
+    for (size_t i = 1; i < Limbs; i++) {
+        if (n.limb[i]) small = false;
+    }
+    if (small) return is_prime_miller_rabin(n.limb[0], k);
+    if (!n.is_odd()) return false;
+
+    static const uint64_t SMALL_PRIMES[] = {3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47,
+                                            53, 59, 61, 67, 71, 73, 79, 83, 89, 97};
+    for (uint64_t p : SMALL_PRIMES) {
+        if (n.mod_small(p) == 0) return false;
+    }
+
+    // Decompose n - 1 = 2^s * d
+    Num d = n;
+    d.limb[0] ^= 1; // n is odd, so this is n - 1
+    size_t s = 0;
+    while (!d.bit(s)) s++;
+    big_shift_right(d, s);
+
+    MontgomeryMP<Limbs> ctx(n);
+    size_t n_bits = n.bit_length();
+
+    for (int round = 0; round < k; round++) {
+        // Uniform base in [2, n - 2] by rejection sampling on n's bit length
+        Num a;
+        Num n_minus_2 = n;
+        big_sub(n_minus_2, Num::from_u64(2));
+        do {
+            for (size_t i = 0; i < Limbs; i++) {
+                a.limb[i] = i * 64 < n_bits ? get_random_range_public(0, UINT64_MAX) : 0;
+            }
+            if (n_bits % 64) a.limb[(n_bits - 1) / 64] &= (1ULL << (n_bits % 64)) - 1;
+        } while (big_compare(a, Num::from_u64(2)) < 0 || big_compare(a, n_minus_2) > 0);
+
+        Num x = ctx.power(ctx.to_mont(a), d);
+        if (big_compare(x, ctx.one) == 0 || big_compare(x, ctx.minus_one) == 0)
+            continue;
+
+        bool witness = true;
+        for (size_t r = 1; r < s; r++) {
+            x = ctx.mul(x, x);
+            if (big_compare(x, ctx.minus_one) == 0) {
+                witness = false;
+                break;
+            }
+            if (big_compare(x, ctx.one) == 0) break;
+        }
+        if (witness) return false; // Composite
+    }
+
+    return true;
+}
+
 #endif // MILLER_RABIN_HPP
\ No newline at end of file
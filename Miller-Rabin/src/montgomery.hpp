@@ -0,0 +1,85 @@
+#ifndef MONTGOMERY_HPP
+#define MONTGOMERY_HPP
+
+#include <cstdint> // For uint64_t
+
+/**
+ * Montgomery arithmetic context for a fixed odd modulus n < 2^64.
+ * All values handled by the mont_* helpers live in Montgomery form
+ * (a * 2^64 mod n), so a modular multiplication costs two 64x64 multiplies
+ * and a subtraction instead of a 128-bit division.
+ * Build it once per n with mont_init() and reuse it for every round.
+ */
+struct MontgomeryContext {
+    uint64_t n;      // The (odd) modulus
+    uint64_t n_inv;  // n^-1 mod 2^64
+    uint64_t r2;     // 2^128 mod n, used to enter Montgomery form
+    uint64_t one;    // 1 in Montgomery form (2^64 mod n)
+    uint64_t minus_one; // n - 1 in Montgomery form
+};
+
+/*
+ * Montgomery reduction (REDC): returns t * 2^-64 mod n for t < n * 2^64.
+ */
+inline uint64_t mont_reduce(const MontgomeryContext& ctx, unsigned __int128 t) {
+    uint64_t m = (uint64_t)t * ctx.n_inv;
+    uint64_t mn_hi = (uint64_t)(((unsigned __int128)m * ctx.n) >> 64);
+    uint64_t t_hi = (uint64_t)(t >> 64);
+    // The low halves of t and m*n cancel, so only the high halves matter
+    uint64_t res = t_hi - mn_hi;
+    if (t_hi < mn_hi) res += ctx.n;
+    return res;
+}
+
+inline uint64_t mont_mul(const MontgomeryContext& ctx, uint64_t a, uint64_t b) {
+    return mont_reduce(ctx, (unsigned __int128)a * b);
+}
+
+inline uint64_t mont_to(const MontgomeryContext& ctx, uint64_t a) {
+    return mont_mul(ctx, a % ctx.n, ctx.r2);
+}
+
+inline uint64_t mont_from(const MontgomeryContext& ctx, uint64_t a) {
+    return mont_reduce(ctx, a);
+}
+
+/**
+ * Prepares the context for modulus n. n must be odd.
+ * This is the only place that pays for a hardware division.
+ */
+inline MontgomeryContext mont_init(uint64_t n) {
+    MontgomeryContext ctx;
+    ctx.n = n;
+
+    // Newton iteration: each step doubles the number of correct low bits
+    uint64_t inv = n; // Correct to 3 bits for any odd n
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - n * inv;
+    }
+    ctx.n_inv = inv;
+
+    uint64_t r = (0 - n) % n; // 2^64 mod n
+    ctx.one = r;
+    ctx.r2 = (uint64_t)((unsigned __int128)r * r % n);
+    ctx.minus_one = n - r;
+    return ctx;
+}
+
+/**
+ * Modular exponentiation with the base already in Montgomery form.
+ * Returns base^exp in Montgomery form.
+ */
+inline uint64_t mont_power(const MontgomeryContext& ctx, uint64_t base, uint64_t exp) {
+    uint64_t res = ctx.one;
+
+    while (exp > 0) {
+        if (exp & 1) {
+            res = mont_mul(ctx, res, base);
+        }
+        base = mont_mul(ctx, base, base);
+        exp >>= 1;
+    }
+    return res;
+}
+
+#endif // MONTGOMERY_HPP
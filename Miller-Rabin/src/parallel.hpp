@@ -0,0 +1,52 @@
+#ifndef PARALLEL_HPP
+#define PARALLEL_HPP
+
+#include <atomic>  // For the shared work counter
+#include <cstddef> // For size_t
+#include <thread>  // For std::thread
+#include <vector>
+
+/**
+ * Number of hardware threads, never less than 1.
+ */
+inline unsigned hardware_threads() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+/**
+ * Runs fn(i) for every i in [0, count) on a pool of 'threads' workers.
+ * Indices are handed out one at a time from a shared counter, so uneven
+ * work still balances. fn should write its result to slot i of a
+ * pre-sized output, which keeps results in input order.
+ * With threads <= 1 everything runs on the calling thread.
+ */
+template <typename Fn>
+void parallel_for(size_t count, unsigned threads, Fn fn) {
+    if (threads <= 1 || count <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            fn(i);
+        }
+        return;
+    }
+    if (threads > count) threads = (unsigned)count;
+
+    std::atomic<size_t> next(0);
+    std::vector<std::thread> pool;
+    pool.reserve(threads);
+
+    for (unsigned t = 0; t < threads; t++) {
+        pool.emplace_back([&]() {
+            for (;;) {
+                size_t i = next.fetch_add(1);
+                if (i >= count) break;
+                fn(i);
+            }
+        });
+    }
+    for (size_t t = 0; t < pool.size(); t++) {
+        pool[t].join();
+    }
+}
+
+#endif // PARALLEL_HPP
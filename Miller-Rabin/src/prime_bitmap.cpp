@@ -0,0 +1,90 @@
+#include "prime_bitmap.hpp"
+#include "parallel.hpp"
+#include "segmented_sieve.hpp"
+#include <cstdio>   // For fopen/fwrite
+#include <cstring>  // For memcmp/memcpy
+#include <vector>
+#include <fcntl.h>    // For open
+#include <sys/mman.h> // For mmap
+#include <sys/stat.h> // For fstat
+#include <unistd.h>   // For close
+
+/*
+ * File header: 8-byte magic followed by the exclusive limit.
+ * The bitmap bytes start right after it.
+ */
+static const char BITMAP_MAGIC[8] = {'M', 'R', 'P', 'R', 'I', 'M', 'E', '1'};
+
+struct BitmapHeader {
+    char magic[8];
+    uint64_t limit;
+};
+
+// Bitmap bytes sieved per parallel task (about 31M numbers)
+static const uint64_t BLOCK_BYTES = 1 << 20;
+
+bool write_prime_bitmap(const char* path, uint64_t limit, unsigned threads) {
+    uint64_t bytes = (limit + 29) / 30;
+    std::vector<uint8_t> bits(bytes, 0);
+
+    // Blocks start on multiples of 30, so no two tasks touch the same byte
+    uint64_t blocks = (bytes + BLOCK_BYTES - 1) / BLOCK_BYTES;
+    parallel_for(blocks, threads, [&](size_t block) {
+        uint64_t a = block * BLOCK_BYTES * 30;
+        uint64_t end = a + BLOCK_BYTES * 30;
+        if (end > limit) end = limit;
+        std::vector<uint64_t> primes = primes_in_range(a, end - 1);
+        for (uint64_t p : primes) {
+            int bit = WHEEL30_BIT[p % 30];
+            if (bit >= 0) bits[p / 30] |= (uint8_t)(1 << bit); // 2, 3, 5 are implicit
+        }
+    });
+
+    FILE* file = fopen(path, "wb");
+    if (!file) return false;
+
+    BitmapHeader header;
+    memcpy(header.magic, BITMAP_MAGIC, sizeof(BITMAP_MAGIC));
+    header.limit = limit;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(bits.data(), 1, bits.size(), file) == bits.size();
+    return fclose(file) == 0 && ok;
+}
+
+bool open_prime_bitmap(const char* path, PrimeBitmap& bitmap) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(BitmapHeader)) {
+        close(fd);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd); // The mapping keeps the file alive
+    if (mapping == MAP_FAILED) return false;
+
+    const BitmapHeader* header = (const BitmapHeader*)mapping;
+    uint64_t bytes = (header->limit + 29) / 30;
+    if (memcmp(header->magic, BITMAP_MAGIC, sizeof(BITMAP_MAGIC)) != 0 ||
+        (uint64_t)st.st_size < sizeof(BitmapHeader) + bytes) {
+        munmap(mapping, st.st_size);
+        return false;
+    }
+
+    // Lookups are scattered, so readahead would only waste I/O
+    madvise(mapping, st.st_size, MADV_RANDOM);
+
+    bitmap.bits = (const uint8_t*)mapping + sizeof(BitmapHeader);
+    bitmap.limit = header->limit;
+    bitmap.mapping = mapping;
+    bitmap.mapping_size = st.st_size;
+    return true;
+}
+
+void close_prime_bitmap(PrimeBitmap& bitmap) {
+    if (bitmap.mapping) munmap(bitmap.mapping, bitmap.mapping_size);
+    bitmap = PrimeBitmap();
+}
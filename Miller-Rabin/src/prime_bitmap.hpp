@@ -0,0 +1,70 @@
+#ifndef PRIME_BITMAP_HPP
+#define PRIME_BITMAP_HPP
+
+#include <cstddef> // For size_t
+#include <cstdint> // For uint64_t, uint8_t
+#include "miller_rabin.hpp"
+
+/**
+ * Default range covered by the bitmap file: every n < 2^32.
+ */
+const uint64_t PRIME_BITMAP_LIMIT = 1ULL << 32;
+
+/**
+ * A primality bitmap mapped read-only from disk.
+ * Layout is a mod-30 wheel: byte i covers [30i, 30i + 30) and bit j is set
+ * when 30i + WHEEL30_RESIDUES[j] is prime. Only the 8 residues coprime to 30
+ * are stored, so 2^32 numbers fit in about 143 MB.
+ */
+struct PrimeBitmap {
+    const uint8_t* bits = nullptr; // First data byte (after the file header)
+    uint64_t limit = 0;            // Lookups are valid for n < limit
+    void* mapping = nullptr;       // Whole mapped file, for munmap
+    size_t mapping_size = 0;
+};
+
+/*
+ * Bit index of each residue mod 30, or -1 when the residue shares a factor with 30.
+ */
+static const int8_t WHEEL30_BIT[30] = {
+    -1,  0, -1, -1, -1, -1, -1,  1, -1, -1,
+    -1,  2, -1,  3, -1, -1, -1,  4, -1,  5,
+    -1, -1, -1,  6, -1, -1, -1, -1, -1,  7,
+};
+
+/**
+ * Sieves [0, limit) and writes the bitmap file to 'path'.
+ * Blocks of the range are sieved in parallel with the segmented sieve.
+ * @return false if the file cannot be written.
+ */
+bool write_prime_bitmap(const char* path, uint64_t limit = PRIME_BITMAP_LIMIT,
+                        unsigned threads = 1);
+
+/**
+ * Maps a file written by write_prime_bitmap(). Pages are loaded lazily by the OS.
+ * @return false if the file is missing, truncated or not a bitmap.
+ */
+bool open_prime_bitmap(const char* path, PrimeBitmap& bitmap);
+
+void close_prime_bitmap(PrimeBitmap& bitmap);
+
+/**
+ * O(1) lookup: one division by a constant and one byte load. Requires n < bitmap.limit.
+ */
+inline bool prime_bitmap_lookup(const PrimeBitmap& bitmap, uint64_t n) {
+    if (n < 7) return n == 2 || n == 3 || n == 5;
+    int bit = WHEEL30_BIT[n % 30];
+    if (bit < 0) return false;
+    return (bitmap.bits[n / 30] >> bit) & 1;
+}
+
+/**
+ * Exact primality test: bitmap lookup below bitmap.limit, deterministic
+ * Miller-Rabin above it.
+ */
+inline bool is_prime_mapped(const PrimeBitmap& bitmap, uint64_t n) {
+    if (n < bitmap.limit) return prime_bitmap_lookup(bitmap, n);
+    return is_prime_deterministic(n);
+}
+
+#endif // PRIME_BITMAP_HPP
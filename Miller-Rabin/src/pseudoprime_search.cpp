@@ -0,0 +1,211 @@
+#include "pseudoprime_search.hpp"
+#include "factor.hpp"
+#include "miller_rabin.hpp"
+#include "parallel.hpp"
+#include "segmented_sieve.hpp"
+#include <cmath>   // For sqrtl
+#include <cstdint>
+#include <numeric> // For std::gcd
+#include <vector>
+
+/*
+ * Layout: index i of a segment stands for the odd number x0 + 2i.
+ * Each number keeps the product of its prime factors up to sqrt(bound)
+ * (8 bytes) and a flag byte, so 128K numbers per segment is a little over 1 MiB.
+ */
+static const uint64_t SEGMENT_ODDS = 1 << 17;
+
+// Segments per parallel task: enough to amortise computing start offsets
+static const uint64_t SEGMENTS_PER_TASK = 32;
+
+// Flag bits: the condition already failed for some prime factor
+static const uint8_t NOT_CARMICHAEL = 1;
+static const uint8_t NOT_FERMAT_BASE2 = 2; // 2^(n-1) != 1 (mod p) for some p | n
+
+/*
+ * One sieving prime with what the per-prime checks need.
+ * n * inverse <= limit iff p | n, and then n * inverse is n / p exactly.
+ */
+struct SearchPrime {
+    uint64_t p;
+    uint64_t order; // ord_p(2), a divisor of p - 1
+    uint64_t inverse;
+    uint64_t limit;
+};
+
+/*
+ * Helper: Multiplicative order of 2 modulo the odd prime p.
+ * Start from p - 1 and drop each prime factor while 2^(order / r) stays 1.
+ */
+static uint64_t order_of_two(uint64_t p) {
+    uint64_t order = p - 1;
+    std::vector<uint64_t> factors = factor(p - 1);
+    for (size_t i = 0; i < factors.size(); i++) {
+        uint64_t r = factors[i];
+        if (order % r == 0 && power(2, order / r, p) == 1) order /= r;
+    }
+    return order;
+}
+
+static SearchPrime make_search_prime(uint64_t p) {
+    SearchPrime sp;
+    sp.p = p;
+    sp.order = order_of_two(p);
+
+    // Newton iteration: each step doubles the number of correct low bits
+    uint64_t inv = p;
+    for (int i = 0; i < 5; i++) {
+        inv *= 2 - p * inv;
+    }
+    sp.inverse = inv;
+    sp.limit = UINT64_MAX / p;
+    return sp;
+}
+
+/*
+ * Shared description of one search over the odd numbers [3, bound].
+ */
+struct SearchJob {
+    uint64_t lo;    // First odd number
+    uint64_t count; // Number of odd numbers in the range
+    std::vector<SearchPrime> primes;
+};
+
+/*
+ * Sieves odd indices [begin, end) of the job and appends what it finds.
+ */
+static void search_block(const SearchJob& job, uint64_t begin, uint64_t end,
+                         std::vector<Pseudoprime>& found) {
+    size_t prime_count = job.primes.size();
+
+    // Per prime: next index to strike (relative to 'begin'), and for the
+    // n = p * j struck there, j mod (p - 1), j mod ord_p(2) and j mod p.
+    // Since p = 1 modulo the first two, n - 1 = j - 1 modulo both, so
+    // Korselt's condition for p is j = 1 (mod p - 1) and 2^(n-1) = 1 (mod p)
+    // is j = 1 (mod ord_p(2)); j = 0 (mod p) means p^2 | n.
+    std::vector<uint64_t> next(prime_count), korselt(prime_count), fermat(prime_count),
+        square(prime_count);
+    uint64_t first = job.lo + 2 * begin;
+    for (size_t k = 0; k < prime_count; k++) {
+        const SearchPrime& sp = job.primes[k];
+        uint64_t j = (first + sp.p - 1) / sp.p;
+        if (j < 3) j = 3; // j = 1 is p itself
+        if (j % 2 == 0) j++;
+        next[k] = (sp.p * j - first) / 2;
+        korselt[k] = j % (sp.p - 1);
+        fermat[k] = j % sp.order;
+        square[k] = j % sp.p;
+    }
+
+    std::vector<uint64_t> smooth(SEGMENT_ODDS);
+    std::vector<uint8_t> flags(SEGMENT_ODDS);
+
+    for (uint64_t seg_start = begin; seg_start < end; seg_start += SEGMENT_ODDS) {
+        uint64_t seg_len = end - seg_start < SEGMENT_ODDS ? end - seg_start : SEGMENT_ODDS;
+        uint64_t x0 = job.lo + 2 * seg_start;
+        for (uint64_t i = 0; i < seg_len; i++) {
+            smooth[i] = 1;
+            flags[i] = 0;
+        }
+
+        // Multiply p into every odd multiple's smooth part, checking p's two conditions on the way
+        uint64_t seg_offset = seg_start - begin;
+        for (size_t k = 0; k < prime_count; k++) {
+            if (next[k] >= seg_offset + seg_len) continue;
+            const SearchPrime& sp = job.primes[k];
+            uint64_t i = next[k] - seg_offset;
+            uint64_t kj = korselt[k], fj = fermat[k], sj = square[k];
+            for (; i < seg_len; i += sp.p) {
+                if (fj != 1) {
+                    // Ruled out: its factorisation no longer matters
+                    flags[i] = NOT_FERMAT_BASE2;
+                } else if (!(flags[i] & NOT_FERMAT_BASE2)) {
+                    uint64_t power_of_p = sp.p;
+                    uint8_t f = kj != 1 ? NOT_CARMICHAEL : 0;
+                    if (sj == 0) {
+                        // p^2 | n: find the full power of p in n
+                        f = NOT_CARMICHAEL;
+                        uint64_t r = (x0 + 2 * i) * sp.inverse * sp.inverse;
+                        power_of_p *= sp.p;
+                        while (r * sp.inverse <= sp.limit) {
+                            r *= sp.inverse;
+                            power_of_p *= sp.p;
+                        }
+                    }
+                    smooth[i] *= power_of_p;
+                    flags[i] |= f;
+                }
+
+                // The next odd multiple has j + 2
+                kj += 2;
+                if (kj >= sp.p - 1) kj -= sp.p - 1;
+                fj += 2;
+                if (fj >= sp.order) fj -= sp.order;
+                sj += 2;
+                if (sj >= sp.p) sj -= sp.p;
+            }
+            next[k] = seg_offset + i;
+            korselt[k] = kj;
+            fermat[k] = fj;
+            square[k] = sj;
+        }
+
+        for (uint64_t i = 0; i < seg_len; i++) {
+            uint64_t n = x0 + 2 * i;
+            uint64_t m = smooth[i]; // n = m * q, q = 1 or one prime above sqrt(bound)
+            // Primes, and numbers already failing a Fermat condition (every
+            // Carmichael number passes them all)
+            if (m == 1 || (flags[i] & NOT_FERMAT_BASE2)) continue;
+
+            int kinds = 0;
+            if (m == n) {
+                if (!(flags[i] & NOT_CARMICHAEL)) kinds |= PSEUDOPRIME_CARMICHAEL;
+            } else {
+                // Korselt fails for q (m < q - 1), but q's Fermat condition
+                // needs ord_q(2) | gcd(m - 1, q - 1), so 2^gcd > q. Most m
+                // fail 2^(m-1) > q = n / m on size alone, with no division.
+                if (m < 40 && (m << (m - 1)) <= n) continue;
+                uint64_t q = n / m;
+                uint64_t g = std::gcd(m - 1, q - 1);
+                if (g < 64 && (1ULL << g) <= q) continue;
+            }
+            if (is_strong_probable_prime(n, 2)) kinds |= PSEUDOPRIME_STRONG_BASE2;
+            if (kinds) found.push_back({n, kinds});
+        }
+    }
+}
+
+std::vector<Pseudoprime> find_pseudoprimes(uint64_t bound, unsigned threads) {
+    std::vector<Pseudoprime> result;
+    if (bound > PSEUDOPRIME_SEARCH_LIMIT) bound = PSEUDOPRIME_SEARCH_LIMIT;
+    if (bound < 9) return result; // 9 is the smallest odd composite
+
+    uint64_t root = (uint64_t)sqrtl((long double)bound);
+    while (root * root > bound) root--;
+    while ((root + 1) * (root + 1) <= bound) root++;
+
+    SearchJob job;
+    job.lo = 3;
+    job.count = ((bound % 2 ? bound : bound - 1) - job.lo) / 2 + 1;
+    std::vector<uint64_t> primes = primes_in_range(3, root, threads);
+    job.primes.resize(primes.size());
+    parallel_for(primes.size(), threads, [&](size_t i) {
+        job.primes[i] = make_search_prime(primes[i]);
+    });
+
+    uint64_t task_odds = SEGMENT_ODDS * SEGMENTS_PER_TASK;
+    size_t tasks = (size_t)((job.count + task_odds - 1) / task_odds);
+    std::vector<std::vector<Pseudoprime> > found(tasks);
+
+    parallel_for(tasks, threads, [&](size_t t) {
+        uint64_t begin = t * task_odds;
+        uint64_t end = job.count - begin < task_odds ? job.count : begin + task_odds;
+        search_block(job, begin, end, found[t]);
+    });
+
+    // Tasks cover increasing sub-ranges, so concatenating keeps the order
+    for (size_t t = 0; t < tasks; t++) {
+        result.insert(result.end(), found[t].begin(), found[t].end());
+    }
+    return result;
+}
@@ -0,0 +1,42 @@
+#ifndef PSEUDOPRIME_SEARCH_HPP
+#define PSEUDOPRIME_SEARCH_HPP
+
+#include <cstdint> // For uint64_t
+#include <vector>
+
+/**
+ * Largest bound find_pseudoprimes() accepts. The sieve keeps per-prime state
+ * for every prime up to sqrt(bound), which stays small up to here.
+ */
+const uint64_t PSEUDOPRIME_SEARCH_LIMIT = 1ULL << 48;
+
+/**
+ * Bit flags for what a number is; a Carmichael number can be both.
+ */
+enum PseudoprimeKind {
+    PSEUDOPRIME_CARMICHAEL = 1, // Korselt: squarefree and (p - 1) | (n - 1) for every p | n
+    PSEUDOPRIME_STRONG_BASE2 = 2 // Odd composite passing the base-2 Miller-Rabin round
+};
+
+struct Pseudoprime {
+    uint64_t n;
+    int kinds; // PseudoprimeKind flags
+};
+
+/**
+ * Every Carmichael number and every base-2 strong pseudoprime up to 'bound',
+ * in increasing order.
+ *
+ * Odd numbers are factored by a segmented sieve over the primes up to
+ * sqrt(bound). While striking n = p * j the sieve also checks, per prime,
+ * the two conditions that p imposes: j = 1 (mod p - 1) for Korselt and
+ * j = 1 (mod ord_p(2)) for 2^(n-1) = 1 (mod p). Both residues are stepped
+ * along with j, so the checks cost no divisions. Only numbers that meet
+ * every condition reach the Miller-Rabin round.
+ *
+ * @param bound   Inclusive upper end; larger values are clamped to PSEUDOPRIME_SEARCH_LIMIT.
+ * @param threads Worker threads; the range is split into blocks of segments.
+ */
+std::vector<Pseudoprime> find_pseudoprimes(uint64_t bound, unsigned threads = 1);
+
+#endif // PSEUDOPRIME_SEARCH_HPP
@@ -0,0 +1,260 @@
+#include "segmented_sieve.hpp"
+#include "miller_rabin.hpp"
+#include "parallel.hpp"
+#include <array>
+#include <cstdint>
+#include <cstring> // For memset
+#include <vector>
+
+/*
+ * Layout: bit i of a block stands for the odd number lo + 2i.
+ * 128 KiB per segment (about 2M numbers) keeps the bitset in L2.
+ */
+static const uint64_t SEGMENT_BYTES = 128 * 1024;
+static const uint64_t SEGMENT_WORDS = SEGMENT_BYTES / 8;
+static const uint64_t SEGMENT_BITS = SEGMENT_BYTES * 8;
+
+// Segments per parallel task: enough to amortise computing start offsets
+static const uint64_t SEGMENTS_PER_TASK = 16;
+
+/*
+ * Wheel pre-sieve for 3, 5, 7, 11 and 13.
+ * The odd number x = 2t + 1 is coprime to all of them iff bit (t mod WHEEL_PERIOD)
+ * of the pattern is set, so each segment starts as a shifted copy of it.
+ */
+static constexpr uint64_t WHEEL_PRIMES[] = {3, 5, 7, 11, 13};
+static constexpr uint64_t WHEEL_PERIOD = 3 * 5 * 7 * 11 * 13;
+
+// Long enough to read SEGMENT_BITS starting at any phase < WHEEL_PERIOD
+static constexpr size_t WHEEL_WORDS = (WHEEL_PERIOD + SEGMENT_BITS) / 64 + 2;
+
+/*
+ * Built by the compiler one word at a time: in word w, q strikes the bits
+ * t with 64w + t = (q - 1) / 2 (mod q), every q-th bit from the first one.
+ */
+struct WheelPattern {
+    std::array<uint64_t, WHEEL_WORDS> words;
+
+    constexpr WheelPattern() : words() {
+        for (size_t w = 0; w < WHEEL_WORDS; w++) {
+            uint64_t struck = 0;
+            for (uint64_t q : WHEEL_PRIMES) {
+                uint64_t first = ((q - 1) / 2 + q - (64 * w) % q) % q;
+                for (uint64_t t = first; t < 64; t += q) {
+                    struck |= 1ULL << t;
+                }
+            }
+            words[w] = ~struck;
+        }
+    }
+};
+
+static constexpr WheelPattern WHEEL_PATTERN;
+
+static const WheelPattern& wheel_pattern() {
+    return WHEEL_PATTERN;
+}
+
+/*
+ * Odd sieving primes from 17 up to 'limit' (plain sieve, limit <= SIEVE_PRIME_LIMIT).
+ */
+static std::vector<uint32_t> sieving_primes(uint64_t limit) {
+    std::vector<uint32_t> primes;
+    std::vector<bool> composite(limit + 1, false);
+    for (uint64_t i = 3; i * i <= limit; i += 2) {
+        if (composite[i]) continue;
+        for (uint64_t j = i * i; j <= limit; j += 2 * i) {
+            composite[j] = true;
+        }
+    }
+    for (uint64_t i = 17; i <= limit; i += 2) {
+        if (!composite[i]) primes.push_back((uint32_t)i);
+    }
+    return primes;
+}
+
+// Integer square root, exact for all 64-bit inputs
+static uint64_t isqrt(uint64_t n) {
+    uint64_t r = 0;
+    for (int bit = 31; bit >= 0; bit--) {
+        uint64_t c = r | (1ULL << bit);
+        if (c * c <= n) r = c;
+    }
+    return r;
+}
+
+/*
+ * Shared description of one sieve job over the odd numbers [lo, hi].
+ */
+struct SieveJob {
+    uint64_t lo;               // First odd number (>= 3)
+    uint64_t count;            // Number of odd numbers in the range
+    uint64_t sieve_limit;      // Largest sieving prime actually used
+    bool needs_mr;             // True when survivors above sieve_limit^2 must be confirmed
+    std::vector<uint32_t> primes;
+};
+
+/*
+ * Sieves odd indices [begin, end) of the job and calls emit(value) on every prime.
+ */
+template <typename Emit>
+static void sieve_block(const SieveJob& job, uint64_t begin, uint64_t end, Emit emit) {
+    const WheelPattern& wheel = wheel_pattern();
+    std::vector<uint64_t> seg(SEGMENT_WORDS);
+
+    // Next index (relative to 'begin') to strike for each sieving prime
+    std::vector<uint64_t> next(job.primes.size());
+    uint64_t first = job.lo + 2 * begin;
+    for (size_t i = 0; i < job.primes.size(); i++) {
+        uint64_t p = job.primes[i];
+        if (p * p >= first) {
+            next[i] = (p * p - first) / 2;
+        } else {
+            // Distance to the next multiple of p, made odd-multiple so it is even
+            uint64_t k = (p - first % p) % p;
+            if (k & 1) k += p;
+            next[i] = k / 2;
+        }
+    }
+
+    uint64_t square_limit = job.sieve_limit * job.sieve_limit;
+    std::vector<uint64_t> survivors;
+    std::vector<uint8_t> verdict;
+
+    for (uint64_t seg_start = begin; seg_start < end; seg_start += SEGMENT_BITS) {
+        uint64_t seg_bits = end - seg_start < SEGMENT_BITS ? end - seg_start : SEGMENT_BITS;
+        uint64_t seg_words = (seg_bits + 63) / 64;
+        uint64_t x0 = job.lo + 2 * seg_start;
+
+        // Pre-sieve: copy the wheel pattern at this segment's phase
+        uint64_t phase = (x0 >> 1) % WHEEL_PERIOD;
+        uint64_t base = phase / 64, shift = phase % 64;
+        for (uint64_t w = 0; w < seg_words; w++) {
+            uint64_t lo_word = wheel.words[base + w];
+            seg[w] = shift ? (lo_word >> shift) | (wheel.words[base + w + 1] << (64 - shift)) : lo_word;
+        }
+        // The wheel primes themselves were removed along with their multiples
+        for (uint64_t q : WHEEL_PRIMES) {
+            if (q >= x0 && (q - x0) / 2 < seg_bits) {
+                uint64_t j = (q - x0) / 2;
+                seg[j / 64] |= 1ULL << (j % 64);
+            }
+        }
+
+        // Strike odd multiples of each sieving prime
+        uint64_t seg_offset = seg_start - begin;
+        for (size_t i = 0; i < job.primes.size(); i++) {
+            uint64_t p = job.primes[i];
+            uint64_t j = next[i] - seg_offset;
+            if (next[i] < seg_offset + seg_bits) {
+                for (; j < seg_bits; j += p) {
+                    seg[j / 64] &= ~(1ULL << (j % 64));
+                }
+                next[i] = seg_offset + j;
+            }
+        }
+
+        // Drop bits past the end of the range
+        if (seg_bits % 64) seg[seg_words - 1] &= (1ULL << (seg_bits % 64)) - 1;
+
+        if (!job.needs_mr) {
+            for (uint64_t w = 0; w < seg_words; w++) {
+                uint64_t bits = seg[w];
+                while (bits) {
+                    uint64_t j = w * 64 + __builtin_ctzll(bits);
+                    bits &= bits - 1;
+                    emit(x0 + 2 * j);
+                }
+            }
+            continue;
+        }
+
+        // Survivors above sieve_limit^2 may still have a large factor:
+        // confirm them all at once through the batched Miller-Rabin
+        survivors.clear();
+        for (uint64_t w = 0; w < seg_words; w++) {
+            uint64_t bits = seg[w];
+            while (bits) {
+                uint64_t j = w * 64 + __builtin_ctzll(bits);
+                bits &= bits - 1;
+                survivors.push_back(x0 + 2 * j);
+            }
+        }
+        size_t proven = 0; // Survivors <= sieve_limit^2 are already known prime
+        while (proven < survivors.size() && survivors[proven] <= square_limit) proven++;
+        verdict.resize(survivors.size());
+        is_prime_batch(survivors.data() + proven, survivors.size() - proven, verdict.data() + proven);
+        for (size_t i = 0; i < survivors.size(); i++) {
+            if (i < proven || verdict[i]) emit(survivors[i]);
+        }
+    }
+}
+
+/*
+ * Prepares the job for [a, b]. Returns false if the range holds no odd number >= 3.
+ */
+static bool make_job(uint64_t a, uint64_t b, SieveJob& job) {
+    uint64_t lo = a < 3 ? 3 : a;
+    if (lo % 2 == 0) {
+        if (lo == UINT64_MAX) return false;
+        lo++;
+    }
+    uint64_t hi = b % 2 == 0 ? b - 1 : b;
+    if (b < 3 || lo > hi) return false;
+
+    uint64_t root = isqrt(hi);
+    job.lo = lo;
+    job.count = (hi - lo) / 2 + 1;
+    job.sieve_limit = root < SIEVE_PRIME_LIMIT ? root : SIEVE_PRIME_LIMIT;
+    job.needs_mr = root > SIEVE_PRIME_LIMIT;
+    job.primes = sieving_primes(job.sieve_limit);
+    return true;
+}
+
+std::vector<uint64_t> primes_in_range(uint64_t a, uint64_t b, unsigned threads) {
+    std::vector<uint64_t> result;
+    if (a > b) return result;
+    if (a <= 2 && b >= 2) result.push_back(2);
+
+    SieveJob job;
+    if (!make_job(a, b, job)) return result;
+
+    uint64_t task_bits = SEGMENT_BITS * SEGMENTS_PER_TASK;
+    size_t tasks = (size_t)((job.count + task_bits - 1) / task_bits);
+    std::vector<std::vector<uint64_t> > found(tasks);
+
+    parallel_for(tasks, threads, [&](size_t t) {
+        uint64_t begin = t * task_bits;
+        uint64_t end = job.count - begin < task_bits ? job.count : begin + task_bits;
+        sieve_block(job, begin, end, [&](uint64_t x) { found[t].push_back(x); });
+    });
+
+    // Tasks cover increasing sub-ranges, so concatenating keeps the order
+    for (size_t t = 0; t < tasks; t++) {
+        result.insert(result.end(), found[t].begin(), found[t].end());
+    }
+    return result;
+}
+
+uint64_t count_primes_in_range(uint64_t a, uint64_t b, unsigned threads) {
+    if (a > b) return 0;
+    uint64_t total = (a <= 2 && b >= 2) ? 1 : 0;
+
+    SieveJob job;
+    if (!make_job(a, b, job)) return total;
+
+    uint64_t task_bits = SEGMENT_BITS * SEGMENTS_PER_TASK;
+    size_t tasks = (size_t)((job.count + task_bits - 1) / task_bits);
+    std::vector<uint64_t> counts(tasks, 0);
+
+    parallel_for(tasks, threads, [&](size_t t) {
+        uint64_t begin = t * task_bits;
+        uint64_t end = job.count - begin < task_bits ? job.count : begin + task_bits;
+        sieve_block(job, begin, end, [&](uint64_t) { counts[t]++; });
+    });
+
+    for (size_t t = 0; t < tasks; t++) {
+        total += counts[t];
+    }
+    return total;
+}
@@ -0,0 +1,31 @@
+#ifndef SEGMENTED_SIEVE_HPP
+#define SEGMENTED_SIEVE_HPP
+
+#include <cstdint> // For uint64_t
+#include <vector>
+
+/**
+ * Largest sieving prime. Above SIEVE_PRIME_LIMIT^2 survivors go to Miller-Rabin.
+ */
+const uint64_t SIEVE_PRIME_LIMIT = 1ULL << 22;
+
+/**
+ * Segmented Sieve of Eratosthenes over [a, b] for any 64-bit range.
+ * Only odd numbers are stored (one bit each), segments are sized to stay
+ * in L2, and every segment starts from a copy of a precomputed wheel
+ * pattern with multiples of 3, 5, 7, 11 and 13 already removed.
+ *
+ * Sieving primes are capped at SIEVE_PRIME_LIMIT. When sqrt(b) is larger,
+ * the numbers that survive sieving are confirmed with the deterministic
+ * Miller-Rabin test instead of sieving with ever larger primes.
+ *
+ * @param threads Worker threads; the range is split into blocks of segments.
+ */
+std::vector<uint64_t> primes_in_range(uint64_t a, uint64_t b, unsigned threads = 1);
+
+/**
+ * Counts primes in [a, b], i.e. pi(b) - pi(a - 1), without storing them.
+ */
+uint64_t count_primes_in_range(uint64_t a, uint64_t b, unsigned threads = 1);
+
+#endif // SEGMENTED_SIEVE_HPP
@@ -1,15 +1,226 @@
 #include "trial_division.hpp"
+#include "miller_rabin.hpp" // For the compile-time table check
+#include <cstdint>
+#include <vector>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h> // AVX-512 IFMA intrinsics for the prime-table path
+#define TD_HAVE_AVX512 1
+#endif
 
 bool trial_division(uint64_t n) {
+    return trial_division_constexpr(n);
+}
+
+/*
+ * Precomputed divisibility data for one odd prime p.
+ */
+struct SmallPrime {
+    uint64_t p;
+    uint64_t inverse; // p^-1 mod 2^64
+    uint64_t limit;   // (2^64 - 1) / p
+};
+
+/*
+ * Builds the table by walking the 6k +/- 1 candidates, the same sequence
+ * trial_division() uses, and keeping the ones it reports prime.
+ * Everything is constexpr, so the table is built by the compiler.
+ */
+struct SmallPrimeTable {
+    SmallPrime primes[PREFILTER_PRIME_COUNT];
+    uint64_t square_limit; // Below this, surviving the filter proves primality
+
+    constexpr SmallPrimeTable() : primes(), square_limit(0) {
+        int count = 0;
+        primes[count++] = make(3);
+        for (uint64_t i = 5; count < PREFILTER_PRIME_COUNT; i += 6) {
+            if (trial_division_constexpr(i)) primes[count++] = make(i);
+            if (count < PREFILTER_PRIME_COUNT && trial_division_constexpr(i + 2)) primes[count++] = make(i + 2);
+        }
+        uint64_t largest = primes[PREFILTER_PRIME_COUNT - 1].p;
+        square_limit = largest * largest;
+    }
+
+    static constexpr SmallPrime make(uint64_t p) {
+        SmallPrime sp = {p, 0, 0};
+        uint64_t inv = p; // Newton iteration, as in mont_init()
+        for (int i = 0; i < 5; i++) {
+            inv *= 2 - p * inv;
+        }
+        sp.inverse = inv;
+        sp.limit = UINT64_MAX / p;
+        return sp;
+    }
+};
+
+static constexpr SmallPrimeTable SMALL_PRIME_TABLE;
+
+/*
+ * Helper: Cross-checks the table against the deterministic Miller-Rabin
+ * test and the inverse identities the prefilter relies on.
+ */
+static constexpr bool small_prime_table_ok(const SmallPrimeTable& table) {
+    for (int i = 0; i < PREFILTER_PRIME_COUNT; i++) {
+        const SmallPrime& sp = table.primes[i];
+        if (!is_prime_deterministic_constexpr(sp.p)) return false;
+        if (i > 0 && sp.p <= table.primes[i - 1].p) return false;
+        if (sp.p * sp.inverse != 1 || sp.limit != UINT64_MAX / sp.p) return false;
+    }
+    return true;
+}
+static_assert(small_prime_table_ok(SMALL_PRIME_TABLE), "small prime table is inconsistent");
+static_assert(SMALL_PRIME_TABLE.primes[PREFILTER_PRIME_COUNT - 1].p == 1621,
+              "the 257th prime is 1621");
+
+static const SmallPrimeTable& small_prime_table() {
+    return SMALL_PRIME_TABLE;
+}
+
+PrefilterResult small_prime_prefilter(uint64_t n) {
+    const SmallPrimeTable& table = small_prime_table();
+
+    if (n <= 1) return PREFILTER_COMPOSITE;
+    if (n % 2 == 0) return n == 2 ? PREFILTER_PRIME : PREFILTER_COMPOSITE;
+
+    for (int i = 0; i < PREFILTER_PRIME_COUNT; i++) {
+        const SmallPrime& sp = table.primes[i];
+        if (n * sp.inverse <= sp.limit) {
+            return n == sp.p ? PREFILTER_PRIME : PREFILTER_COMPOSITE;
+        }
+    }
+
+    return n < table.square_limit ? PREFILTER_PRIME : PREFILTER_UNKNOWN;
+}
+
+uint64_t strip_small_factors(uint64_t n, std::vector<uint64_t>& factors) {
+    const SmallPrimeTable& table = small_prime_table();
+    if (n == 0) return 0;
+
+    int twos = __builtin_ctzll(n);
+    factors.insert(factors.end(), twos, 2);
+    n >>= twos;
+
+    for (int i = 0; i < PREFILTER_PRIME_COUNT && n >= table.primes[i].p; i++) {
+        const SmallPrime& sp = table.primes[i];
+        // When p | n the product n * p^-1 is the exact quotient n / p
+        while (n * sp.inverse <= sp.limit) {
+            n *= sp.inverse;
+            factors.push_back(sp.p);
+        }
+    }
+    return n;
+}
+
+uint64_t small_prime_square_limit() {
+    return small_prime_table().square_limit;
+}
+
+/* ===================== Prime-table trial division ===================== */
+
+/*
+ * Odd primes below TRIAL_TABLE_LIMIT, with the inverse-multiply data in
+ * separate columns so a vector can load eight inverses or limits at once.
+ */
+struct TrialTable {
+    std::vector<uint32_t> primes;
+    std::vector<uint64_t> inverse;
+    std::vector<uint64_t> limit;
+
+    TrialTable() {
+        std::vector<bool> composite(TRIAL_TABLE_LIMIT, false);
+        for (uint64_t i = 3; i * i < TRIAL_TABLE_LIMIT; i += 2) {
+            if (composite[i]) continue;
+            for (uint64_t j = i * i; j < TRIAL_TABLE_LIMIT; j += 2 * i) {
+                composite[j] = true;
+            }
+        }
+        for (uint64_t i = 3; i < TRIAL_TABLE_LIMIT; i += 2) {
+            if (composite[i]) continue;
+            SmallPrime sp = SmallPrimeTable::make(i);
+            primes.push_back((uint32_t)i);
+            inverse.push_back(sp.inverse);
+            limit.push_back(sp.limit);
+        }
+    }
+};
+
+static const TrialTable& trial_table() {
+    static const TrialTable table;
+    return table;
+}
+
+/*
+ * Helper: Does any of the first 'count' table primes divide n?
+ */
+static bool table_has_divisor_scalar(uint64_t n, const TrialTable& table, size_t count) {
+    const uint64_t* inverse = table.inverse.data();
+    const uint64_t* limit = table.limit.data();
+    for (size_t i = 0; i < count; i++) {
+        if (n * inverse[i] <= limit[i]) return true;
+    }
+    return false;
+}
+
+#ifdef TD_HAVE_AVX512
+/*
+ * Same test on eight primes per vector, for n < 2^52. AVX-512 IFMA multiplies
+ * the low 52 bits, and the inverse test works modulo 2^52 just as modulo 2^64:
+ * p | n iff n * p^-1 mod 2^52 <= (2^52 - 1) / p. The low 52 bits of the
+ * 64-bit inverse are the 52-bit inverse, and (2^52 - 1) / p = limit >> 12.
+ */
+__attribute__((target("avx512f,avx512ifma")))
+static bool table_has_divisor_ifma(uint64_t n, const TrialTable& table, size_t count) {
+    const uint64_t* inverse = table.inverse.data();
+    const uint64_t* limit = table.limit.data();
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i vn = _mm512_set1_epi64((long long)n);
+
+    size_t i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512i a = _mm512_madd52lo_epu64(zero, vn, _mm512_loadu_si512(inverse + i));
+        __m512i b = _mm512_madd52lo_epu64(zero, vn, _mm512_loadu_si512(inverse + i + 8));
+        __m512i la = _mm512_srli_epi64(_mm512_loadu_si512(limit + i), 12);
+        __m512i lb = _mm512_srli_epi64(_mm512_loadu_si512(limit + i + 8), 12);
+        if (_mm512_cmple_epu64_mask(a, la) | _mm512_cmple_epu64_mask(b, lb)) return true;
+    }
+    for (; i < count; i++) {
+        if (n * inverse[i] <= limit[i]) return true;
+    }
+    return false;
+}
+#endif
+
+bool trial_division_table(uint64_t n) {
     if (n <= 1) return false;
     if (n <= 3) return true;
-    
-    if (n % 2 == 0 || n % 3 == 0) return false;
-    
-    // Check only 6k +/- 1 up to sqrt(n)
-    for (uint64_t i = 5; i * i <= n; i += 6) {
+    if (n % 2 == 0) return false;
+
+    const TrialTable& table = trial_table();
+
+    // Table primes p with p * p <= n
+    size_t count = 0, hi = table.primes.size();
+    while (count < hi) {
+        size_t mid = (count + hi) / 2;
+        uint64_t p = table.primes[mid];
+        if (p * p <= n) count = mid + 1;
+        else            hi = mid;
+    }
+
+#ifdef TD_HAVE_AVX512
+    static const bool use_ifma = __builtin_cpu_supports("avx512ifma");
+    bool divisible = use_ifma && n < (1ULL << 52) ? table_has_divisor_ifma(n, table, count)
+                                                  : table_has_divisor_scalar(n, table, count);
+#else
+    bool divisible = table_has_divisor_scalar(n, table, count);
+#endif
+    if (divisible) return false;
+    if (count < table.primes.size()) return true;
+
+    // Past the table (n >= 2^50): carry on with 6k +/- 1 from the first candidate above it
+    uint64_t i = TRIAL_TABLE_LIMIT / 6 * 6 + 5;
+    for (; i <= UINT32_MAX && i * i <= n; i += 6) {
         if (n % i == 0 || n % (i + 2) == 0)
             return false;
     }
     return true;
-}
\ No newline at end of file
+}
@@ -2,6 +2,7 @@
 #define TRIAL_DIVISION_HPP
 
 #include <cstdint> 
+#include <vector>
 
 /**
  * Deterministic Trial Division
@@ -10,4 +11,72 @@
  */
 bool trial_division(uint64_t n);
 
+/**
+ * The 6k +/- 1 loop behind trial_division(), usable in constant expressions
+ * so small prime tables can be built by the compiler.
+ */
+constexpr bool trial_division_constexpr(uint64_t n) {
+    if (n <= 1) return false;
+    if (n <= 3) return true;
+
+    if (n % 2 == 0 || n % 3 == 0) return false;
+
+    for (uint64_t i = 5; i * i <= n; i += 6) {
+        if (n % i == 0 || n % (i + 2) == 0)
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Table primes run up to here, so trial_division_table() needs no
+ * fallback for n < TRIAL_TABLE_LIMIT^2 = 2^50.
+ */
+const uint64_t TRIAL_TABLE_LIMIT = 1ULL << 25;
+
+/**
+ * Trial division by primes only, from a table built on first use
+ * (about 2.06M primes below TRIAL_TABLE_LIMIT at 20 bytes each, 41 MB).
+ * Divisibility is tested by multiplying with each prime's inverse mod 2^64,
+ * with no division instruction, eight primes per AVX-512 IFMA vector when
+ * the CPU has it. Same answers as trial_division(); above 2^50 the 6k +/- 1
+ * loop continues past the table.
+ */
+bool trial_division_table(uint64_t n);
+
+/**
+ * Number of small primes checked by small_prime_prefilter().
+ */
+const int PREFILTER_PRIME_COUNT = 256;
+
+/**
+ * Outcome of the small-prime prefilter.
+ */
+enum PrefilterResult {
+    PREFILTER_COMPOSITE, // Divisible by a small prime (and not equal to it)
+    PREFILTER_PRIME,     // Proven prime: no small factor and n < (largest small prime)^2
+    PREFILTER_UNKNOWN    // Survived the filter, needs a real primality test
+};
+
+/**
+ * Small-prime prefilter
+ * Tests divisibility of 'n' by the first PREFILTER_PRIME_COUNT primes.
+ * Each test multiplies by a precomputed inverse mod 2^64 instead of
+ * dividing: for odd p, p | n exactly when n * p^-1 <= (2^64 - 1) / p.
+ */
+PrefilterResult small_prime_prefilter(uint64_t n);
+
+/**
+ * Divides out 2 and the PREFILTER_PRIME_COUNT small primes, appending each
+ * one to 'factors' (ascending, with multiplicity), and returns what is left.
+ * The remainder is 1, a prime below small_prime_square_limit(), or a number
+ * whose prime factors are all larger than the small primes.
+ */
+uint64_t strip_small_factors(uint64_t n, std::vector<uint64_t>& factors);
+
+/**
+ * Square of the largest small prime: a remainder below it with no small factor is prime.
+ */
+uint64_t small_prime_square_limit();
+
 #endif // TRIAL_DIVISION_HPP
\ No newline at end of file
@@ -1,5 +1,16 @@
 #include <bits/stdc++.h>
 #include <filesystem>
+#include "sort_engine.hpp"
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h> // AVX2 / AVX-512 partition kernels
+#define QS_HAVE_X86_SIMD 1
+#endif
+#ifdef __linux__
+#include <linux/perf_event.h> // Hardware branch-miss counter
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 using namespace std;
 
 // ---------------------- DETERMINISTIC (LAST PIVOT) -----------------------
@@ -27,9 +38,19 @@ void quicksortDet(vector<int> &arr, int low, int high) {
 
 // ---------------------- RANDOMIZED QUICKSORT (HOARE) -----------------------
 
-int randomizedHoarePartition(vector<int>& arr, int low, int high) {
+// Lomuto partition around a random pivot, kept for the partition-kernel comparison
+int randomizedLomutoPartition(vector<int>& arr, int low, int high) {
     int pivotIndex = low + rand() % (high - low + 1);
-    int pivot = arr[pivotIndex];
+    swap(arr[pivotIndex], arr[high]);
+    return partitionDet(arr, low, high);
+}
+
+// Hoare partition around arr[pivotIndex]; returns j with arr[low..j] <= pivot <= arr[j+1..high]
+int hoarePartitionAt(vector<int>& arr, int low, int high, int pivotIndex) {
+    // Moving the pivot to the front guarantees the split point is below high,
+    // so neither side can come back as the whole range
+    swap(arr[pivotIndex], arr[low]);
+    int pivot = arr[low];
 
     int i = low - 1;
     int j = high + 1;
@@ -45,6 +66,10 @@ int randomizedHoarePartition(vector<int>& arr, int low, int high) {
     }
 }
 
+int randomizedHoarePartition(vector<int>& arr, int low, int high) {
+    return hoarePartitionAt(arr, low, high, low + rand() % (high - low + 1));
+}
+
 void randomizedQuickSort(vector<int>& arr, int low, int high) {
     if (low < high) {
         int p = randomizedHoarePartition(arr, low, high);
@@ -53,6 +78,979 @@ void randomizedQuickSort(vector<int>& arr, int low, int high) {
     }
 }
 
+// ---------------------- HYBRID QUICKSORT (INTROSORT) -----------------------
+
+// Subarrays at or below this size are finished with insertion sort
+const int INSERTION_CUTOFF = 16;
+
+void insertionSort(vector<int>& arr, int low, int high) {
+    for (int i = low + 1; i <= high; i++) {
+        int key = arr[i];
+        int j = i - 1;
+        while (j >= low && arr[j] > key) {
+            arr[j + 1] = arr[j];
+            j--;
+        }
+        arr[j + 1] = key;
+    }
+}
+
+// Max-heap over arr[low .. low + size - 1]; node k has children 2k + 1 and 2k + 2
+void siftDown(vector<int>& arr, int low, int root, int size) {
+    int value = arr[low + root];
+    while (true) {
+        int child = 2 * root + 1;
+        if (child >= size) break;
+        if (child + 1 < size && arr[low + child + 1] > arr[low + child]) child++;
+        if (arr[low + child] <= value) break;
+        arr[low + root] = arr[low + child];
+        root = child;
+    }
+    arr[low + root] = value;
+}
+
+void heapSort(vector<int>& arr, int low, int high) {
+    int size = high - low + 1;
+    for (int i = size / 2 - 1; i >= 0; i--)
+        siftDown(arr, low, i, size);
+    for (int end = size - 1; end > 0; end--) {
+        swap(arr[low], arr[low + end]);
+        siftDown(arr, low, 0, end);
+    }
+}
+
+// Random pivot index in [low, high] from rand(), for single-threaded callers
+struct RandPivot {
+    int operator()(int low, int high) const { return low + rand() % (high - low + 1); }
+};
+
+// pickPivot(low, high) returns the index of the pivot in [low, high]
+template <class PickPivot>
+void introSortLoop(vector<int>& arr, int low, int high, int depthLimit, PickPivot &pickPivot) {
+    while (high - low + 1 > INSERTION_CUTOFF) {
+        // Too many unlucky pivots: heapsort keeps this range O(n log n)
+        if (depthLimit == 0) {
+            heapSort(arr, low, high);
+            return;
+        }
+        depthLimit--;
+
+        int p = hoarePartitionAt(arr, low, high, pickPivot(low, high));
+
+        // Recurse into the smaller side and loop on the larger one,
+        // so the stack never holds more than log2(n) frames
+        if (p - low < high - p) {
+            introSortLoop(arr, low, p, depthLimit, pickPivot);
+            low = p + 1;
+        } else {
+            introSortLoop(arr, p + 1, high, depthLimit, pickPivot);
+            high = p;
+        }
+    }
+    insertionSort(arr, low, high);
+}
+
+template <class PickPivot = RandPivot>
+void hybridQuickSort(vector<int>& arr, int low, int high, PickPivot pickPivot = PickPivot()) {
+    if (low >= high) return;
+    int depthLimit = 2 * (int)log2(high - low + 1);
+    introSortLoop(arr, low, high, depthLimit, pickPivot);
+}
+
+// ---------------------- THREE-WAY QUICKSORT (BENTLEY-MCILROY) -----------------------
+
+// Splits arr[low..high] around a random pivot into < pivot, == pivot and > pivot.
+// Keys equal to the pivot are parked at both ends during the Hoare-style scan
+// and swapped into the middle at the end, so a run of duplicates is finished
+// in the same pass. On return arr[low..lt] < pivot and arr[gt..high] > pivot.
+void randomizedThreeWayPartition(vector<int>& arr, int low, int high, int &lt, int &gt) {
+    int pivotIndex = low + rand() % (high - low + 1);
+    swap(arr[pivotIndex], arr[low]);
+    int pivot = arr[low];
+
+    int i = low, j = high + 1;
+    int p = low, q = high + 1; // arr[low..p] and arr[q..high] hold keys equal to the pivot
+
+    while (true) {
+        while (arr[++i] < pivot)
+            if (i == high) break;
+        while (pivot < arr[--j])
+            if (j == low) break;
+
+        if (i == j && arr[i] == pivot) swap(arr[++p], arr[i]);
+        if (i >= j) break;
+
+        swap(arr[i], arr[j]);
+        if (arr[i] == pivot) swap(arr[++p], arr[i]);
+        if (arr[j] == pivot) swap(arr[--q], arr[j]);
+    }
+
+    // Bring the parked equal keys next to the crossing point
+    i = j + 1;
+    for (int k = low; k <= p; k++) swap(arr[k], arr[j--]);
+    for (int k = high; k >= q; k--) swap(arr[k], arr[i++]);
+
+    lt = j;
+    gt = i;
+}
+
+void threeWayQuickSort(vector<int>& arr, int low, int high) {
+    while (high - low + 1 > INSERTION_CUTOFF) {
+        int lt, gt;
+        randomizedThreeWayPartition(arr, low, high, lt, gt);
+
+        // Keys equal to the pivot are final; recurse into the smaller side
+        if (lt - low < high - gt) {
+            threeWayQuickSort(arr, low, lt);
+            low = gt;
+        } else {
+            threeWayQuickSort(arr, gt, high);
+            high = lt;
+        }
+    }
+    insertionSort(arr, low, high);
+}
+
+// ---------------------- BLOCK QUICKSORT (BRANCHLESS PARTITION) -----------------------
+
+// Elements scanned per block; offsets inside a block fit in one byte
+const int BLOCK_SIZE = 128;
+
+// BlockQuicksort partition (Edelkamp and Weiss). Each side scans a block and
+// records the offsets of misplaced keys with a comparison result added to a
+// counter instead of a branch; the recorded keys are then swapped in pairs.
+// Keys equal to the pivot count as misplaced on both sides, as in Hoare's
+// scheme, so runs of equal keys still split evenly.
+// Returns the pivot's final index: arr[low..m-1] <= pivot <= arr[m+1..high].
+int blockPartitionAt(vector<int>& arr, int low, int high, int pivotIndex) {
+    swap(arr[pivotIndex], arr[high]);
+    int pivot = arr[high];
+    int *a = arr.data();
+
+    // [l, r] is still unpartitioned; everything left of l is <= pivot and
+    // everything right of r (up to high - 1) is >= pivot
+    int l = low, r = high - 1;
+    unsigned char offsetsL[BLOCK_SIZE], offsetsR[BLOCK_SIZE];
+    int startL = 0, numL = 0, startR = 0, numR = 0;
+
+    while (r - l + 1 >= 2 * BLOCK_SIZE) {
+        if (numL == 0) {
+            startL = 0;
+            for (int k = 0; k < BLOCK_SIZE; k++) {
+                offsetsL[numL] = k;
+                numL += !(a[l + k] < pivot);
+            }
+        }
+        if (numR == 0) {
+            startR = 0;
+            for (int k = 0; k < BLOCK_SIZE; k++) {
+                offsetsR[numR] = k;
+                numR += !(pivot < a[r - k]);
+            }
+        }
+
+        int num = min(numL, numR);
+        for (int k = 0; k < num; k++)
+            swap(a[l + offsetsL[startL + k]], a[r - offsetsR[startR + k]]);
+
+        numL -= num;
+        numR -= num;
+        startL += num;
+        startR += num;
+        if (numL == 0) l += BLOCK_SIZE;
+        if (numR == 0) r -= BLOCK_SIZE;
+    }
+
+    // Fewer than two blocks left: finish with a Hoare scan. A block with
+    // unswapped offsets is still inside [l, r] and simply gets scanned again.
+    while (true) {
+        while (l <= r && a[l] < pivot) l++;
+        while (l <= r && pivot < a[r]) r--;
+        if (l >= r) break;
+        swap(a[l], a[r]);
+        l++;
+        r--;
+    }
+
+    // a[l] is the first key of the >= pivot side
+    swap(a[l], a[high]);
+    return l;
+}
+
+int blockPartition(vector<int>& arr, int low, int high) {
+    return blockPartitionAt(arr, low, high, low + rand() % (high - low + 1));
+}
+
+void blockQuickSort(vector<int>& arr, int low, int high) {
+    while (high - low + 1 > INSERTION_CUTOFF) {
+        int p = blockPartition(arr, low, high);
+
+        if (p - low < high - p) {
+            blockQuickSort(arr, low, p - 1);
+            low = p + 1;
+        } else {
+            blockQuickSort(arr, p + 1, high);
+            high = p - 1;
+        }
+    }
+    insertionSort(arr, low, high);
+}
+
+// ---------------------- VECTORIZED PARTITION (AVX2 / AVX-512) -----------------------
+
+enum SimdLevel { SIMD_SCALAR, SIMD_AVX2, SIMD_AVX512 };
+
+// Widest partition kernel this CPU can run, detected once
+SimdLevel bestSimdLevel() {
+#ifdef QS_HAVE_X86_SIMD
+    static const SimdLevel level = __builtin_cpu_supports("avx512f") ? SIMD_AVX512
+                                 : __builtin_cpu_supports("avx2")    ? SIMD_AVX2
+                                                                     : SIMD_SCALAR;
+    return level;
+#else
+    return SIMD_SCALAR;
+#endif
+}
+
+// All kernels below partition a[low..high-1] around pivot = a[high] and return
+// the pivot's final index m. Keys below the pivot (OrEqual: not above it) end
+// up in a[low..m-1], the rest in a[m+1..high].
+
+template <bool OrEqual>
+inline bool goesLeft(int x, int pivot) {
+    return OrEqual ? x <= pivot : x < pivot;
+}
+
+template <bool OrEqual>
+int partitionScalar(int *a, int low, int high, int pivot) {
+    int i = low;
+    for (int j = low; j < high; j++) {
+        if (goesLeft<OrEqual>(a[j], pivot)) {
+            swap(a[i], a[j]);
+            i++;
+        }
+    }
+    swap(a[i], a[high]);
+    return i;
+}
+
+// The vector kernels read one vector from each end up front, so there are
+// always two vectors' worth of free slots between the write and read
+// cursors. Loading next from the side with less free space guarantees a full
+// vector store fits on both sides. What is left at the end (fewer than one
+// vector plus the two preloaded ones) is placed by this scalar tail.
+template <bool OrEqual>
+int finishPartition(int *a, int high, int pivot, const int *rest, int count, int writeL, int writeR) {
+    for (int k = 0; k < count; k++) {
+        if (goesLeft<OrEqual>(rest[k], pivot)) a[writeL++] = rest[k];
+        else a[--writeR] = rest[k];
+    }
+    swap(a[writeL], a[high]);
+    return writeL;
+}
+
+#ifdef QS_HAVE_X86_SIMD
+
+// For each 8-bit mask: lane indices with the set lanes first, then the clear ones
+struct PermuteTable {
+    int lanes[256][8];
+
+    PermuteTable() {
+        for (int mask = 0; mask < 256; mask++) {
+            int k = 0;
+            for (int i = 0; i < 8; i++)
+                if (mask & (1 << i)) lanes[mask][k++] = i;
+            for (int i = 0; i < 8; i++)
+                if (!(mask & (1 << i))) lanes[mask][k++] = i;
+        }
+    }
+};
+
+const PermuteTable AVX2_PERMUTE;
+
+// Permutes the left-going keys of v to the front and stores the vector at
+// both cursors: the front lanes land at writeL, the back lanes end at writeR
+template <bool OrEqual>
+__attribute__((target("avx2")))
+inline void storeSplitAvx2(int *a, __m256i v, __m256i pv, int &writeL, int &writeR) {
+    // AVX2 only has a signed greater-than: x <= pivot is !(x > pivot)
+    int mask = OrEqual ? ~_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(v, pv))) & 0xFF
+                       : _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(pv, v)));
+    int count = __builtin_popcount(mask);
+    __m256i perm = _mm256_loadu_si256((const __m256i *)AVX2_PERMUTE.lanes[mask]);
+    __m256i packed = _mm256_permutevar8x32_epi32(v, perm);
+    _mm256_storeu_si256((__m256i *)(a + writeL), packed);
+    _mm256_storeu_si256((__m256i *)(a + writeR - 8), packed);
+    writeL += count;
+    writeR -= 8 - count;
+}
+
+template <bool OrEqual>
+__attribute__((target("avx2")))
+int partitionAvx2(int *a, int low, int high, int pivot) {
+    const int W = 8;
+    if (high - low < 2 * W) return partitionScalar<OrEqual>(a, low, high, pivot);
+
+    __m256i pv = _mm256_set1_epi32(pivot);
+    int readL = low, readR = high; // a[readL..readR-1] not yet read
+    __m256i first = _mm256_loadu_si256((const __m256i *)(a + readL));
+    __m256i last = _mm256_loadu_si256((const __m256i *)(a + readR - W));
+    readL += W;
+    readR -= W;
+    int writeL = low, writeR = high;
+
+    while (readR - readL >= W) {
+        __m256i v;
+        if (readL - writeL <= writeR - readR) {
+            v = _mm256_loadu_si256((const __m256i *)(a + readL));
+            readL += W;
+        } else {
+            readR -= W;
+            v = _mm256_loadu_si256((const __m256i *)(a + readR));
+        }
+        storeSplitAvx2<OrEqual>(a, v, pv, writeL, writeR);
+    }
+
+    int rest[3 * W];
+    int count = readR - readL;
+    copy(a + readL, a + readR, rest);
+    _mm256_storeu_si256((__m256i *)(rest + count), first);
+    _mm256_storeu_si256((__m256i *)(rest + count + W), last);
+    return finishPartition<OrEqual>(a, high, pivot, rest, count + 2 * W, writeL, writeR);
+}
+
+// Compresses the left-going keys to the front for a full store at writeL,
+// and the others for a masked store ending at writeR
+template <bool OrEqual>
+__attribute__((target("avx512f")))
+inline void storeSplitAvx512(int *a, __m512i v, __m512i pv, int &writeL, int &writeR) {
+    __mmask16 left = OrEqual ? _mm512_cmple_epi32_mask(v, pv) : _mm512_cmplt_epi32_mask(v, pv);
+    int count = __builtin_popcount(left);
+    _mm512_storeu_si512(a + writeL, _mm512_maskz_compress_epi32(left, v));
+    writeL += count;
+    writeR -= 16 - count;
+    _mm512_mask_storeu_epi32(a + writeR, (__mmask16)((1u << (16 - count)) - 1),
+                             _mm512_maskz_compress_epi32((__mmask16)~left, v));
+}
+
+template <bool OrEqual>
+__attribute__((target("avx512f")))
+int partitionAvx512(int *a, int low, int high, int pivot) {
+    const int W = 16;
+    if (high - low < 2 * W) return partitionScalar<OrEqual>(a, low, high, pivot);
+
+    __m512i pv = _mm512_set1_epi32(pivot);
+    int readL = low, readR = high; // a[readL..readR-1] not yet read
+    __m512i first = _mm512_loadu_si512(a + readL);
+    __m512i last = _mm512_loadu_si512(a + readR - W);
+    readL += W;
+    readR -= W;
+    int writeL = low, writeR = high;
+
+    while (readR - readL >= W) {
+        __m512i v;
+        if (readL - writeL <= writeR - readR) {
+            v = _mm512_loadu_si512(a + readL);
+            readL += W;
+        } else {
+            readR -= W;
+            v = _mm512_loadu_si512(a + readR);
+        }
+        storeSplitAvx512<OrEqual>(a, v, pv, writeL, writeR);
+    }
+
+    int rest[3 * W];
+    int count = readR - readL;
+    copy(a + readL, a + readR, rest);
+    _mm512_storeu_si512(rest + count, first);
+    _mm512_storeu_si512(rest + count + W, last);
+    return finishPartition<OrEqual>(a, high, pivot, rest, count + 2 * W, writeL, writeR);
+}
+
+#endif // QS_HAVE_X86_SIMD
+
+template <bool OrEqual>
+int partitionAroundLast(vector<int>& arr, int low, int high, SimdLevel level) {
+    int *a = arr.data();
+    int pivot = a[high];
+#ifdef QS_HAVE_X86_SIMD
+    if (level == SIMD_AVX512) return partitionAvx512<OrEqual>(a, low, high, pivot);
+    if (level == SIMD_AVX2) return partitionAvx2<OrEqual>(a, low, high, pivot);
+#endif
+    return partitionScalar<OrEqual>(a, low, high, pivot);
+}
+
+// Drop-in partition with a random pivot, same contract as blockPartition:
+// returns m with arr[low..m-1] < arr[m] <= arr[m+1..high]
+int vectorizedPartition(vector<int>& arr, int low, int high, SimdLevel level = bestSimdLevel()) {
+    int pivotIndex = low + rand() % (high - low + 1);
+    swap(arr[pivotIndex], arr[high]);
+    return partitionAroundLast<false>(arr, low, high, level);
+}
+
+void vectorizedQuickSort(vector<int>& arr, int low, int high) {
+    while (high - low + 1 > INSERTION_CUTOFF) {
+        int p = vectorizedPartition(arr, low, high);
+
+        if (p == low) {
+            // Nothing was below the pivot, so it is the smallest key: one
+            // more pass gathers all its copies, which are then final. This
+            // keeps runs of equal keys from degrading to quadratic time.
+            swap(arr[low], arr[high]);
+            low = partitionAroundLast<true>(arr, low, high, bestSimdLevel()) + 1;
+            continue;
+        }
+
+        if (p - low < high - p) {
+            vectorizedQuickSort(arr, low, p - 1);
+            low = p + 1;
+        } else {
+            vectorizedQuickSort(arr, p + 1, high);
+            high = p - 1;
+        }
+    }
+    insertionSort(arr, low, high);
+}
+
+// ---------------------- WORK-STEALING PARALLEL QUICKSORT -----------------------
+
+// Ranges at or below this size are sorted sequentially inside one task
+const int PARALLEL_CUTOFF = 1 << 15;
+
+// Ranges at least this large (and larger than one thread's share) are
+// partitioned by all threads together instead of by one task
+const int PARALLEL_PARTITION_MIN = 1 << 20;
+
+// Fork-join pool: each thread owns a deque of tasks, runs its newest task
+// first and, when empty, steals the oldest task of another thread. The
+// thread that creates the pool is worker 0 and works while it waits.
+class WorkStealingPool {
+public:
+    explicit WorkStealingPool(int threads) : queues(threads) {
+        currentWorker = 0;
+        for (int i = 1; i < threads; i++)
+            workers.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ~WorkStealingPool() {
+        stop = true;
+        for (thread &t : workers) t.join();
+    }
+
+    int size() const { return queues.size(); }
+
+    void spawn(function<void()> task) {
+        Queue &q = queues[currentWorker];
+        lock_guard<mutex> lock(q.lock);
+        q.tasks.push_back(move(task));
+    }
+
+    // Runs queued tasks until 'remaining' drops to zero
+    void helpUntilDone(const atomic<int> &remaining) {
+        while (remaining.load() > 0) {
+            if (!runOne(currentWorker)) this_thread::yield();
+        }
+    }
+
+    // Runs body(0) .. body(count - 1) across the pool and waits for all of them
+    void parallelFor(int count, const function<void(int)> &body) {
+        atomic<int> remaining(count);
+        for (int i = 0; i < count; i++) {
+            spawn([&body, &remaining, i] {
+                body(i);
+                remaining--;
+            });
+        }
+        helpUntilDone(remaining);
+    }
+
+private:
+    struct Queue {
+        mutex lock;
+        deque<function<void()>> tasks;
+    };
+
+    vector<Queue> queues;
+    vector<thread> workers;
+    atomic<bool> stop{false};
+    static thread_local int currentWorker;
+
+    bool runOne(int self) {
+        function<void()> task;
+        {
+            Queue &own = queues[self];
+            lock_guard<mutex> lock(own.lock);
+            if (!own.tasks.empty()) {
+                task = move(own.tasks.back());
+                own.tasks.pop_back();
+            }
+        }
+        for (int k = 1; !task && k < (int)queues.size(); k++) {
+            Queue &victim = queues[(self + k) % queues.size()];
+            lock_guard<mutex> lock(victim.lock);
+            if (!victim.tasks.empty()) {
+                task = move(victim.tasks.front());
+                victim.tasks.pop_front();
+            }
+        }
+        if (!task) return false;
+        task();
+        return true;
+    }
+
+    void workerLoop(int self) {
+        currentWorker = self;
+        while (!stop) {
+            if (!runOne(self)) this_thread::yield();
+        }
+    }
+};
+
+thread_local int WorkStealingPool::currentWorker = 0;
+
+// rand() need not be thread-safe (glibc serializes it behind one lock), so
+// tasks draw their pivots from a generator owned by the thread running them
+mt19937 &workerRng() {
+    static atomic<unsigned> nextSeed((unsigned)rand());
+    thread_local mt19937 gen(nextSeed++);
+    return gen;
+}
+
+// Random pivot index in [low, high] from the calling thread's generator
+struct WorkerPivot {
+    int operator()(int low, int high) const {
+        return low + (int)(workerRng()() % (unsigned)(high - low + 1));
+    }
+};
+
+// Three-way partition of arr[low..high] by all threads: each chunk counts its
+// keys below and equal to arr[pivotIndex], prefix sums give every chunk its
+// output offsets, the keys are scattered into tmp and copied back.
+// On return arr[low..lt] < pivot and arr[gt..high] > pivot.
+void parallelThreeWayPartition(WorkStealingPool &pool, vector<int>& arr, vector<int>& tmp,
+                               int low, int high, int pivotIndex, int &lt, int &gt) {
+    int pivot = arr[pivotIndex];
+    int chunks = pool.size();
+    long long n = high - low + 1;
+    auto chunkBegin = [&](int c) { return low + (int)(n * c / chunks); };
+
+    vector<int> less(chunks), equal(chunks);
+    pool.parallelFor(chunks, [&](int c) {
+        int l = 0, e = 0;
+        for (int i = chunkBegin(c); i < chunkBegin(c + 1); i++) {
+            l += arr[i] < pivot;
+            e += arr[i] == pivot;
+        }
+        less[c] = l;
+        equal[c] = e;
+    });
+
+    int totalLess = 0, totalEqual = 0;
+    for (int c = 0; c < chunks; c++) {
+        totalLess += less[c];
+        totalEqual += equal[c];
+    }
+
+    // Output cursors of each chunk in the <, == and > regions
+    vector<int> lessAt(chunks), equalAt(chunks), greaterAt(chunks);
+    int l = low, e = low + totalLess, g = low + totalLess + totalEqual;
+    for (int c = 0; c < chunks; c++) {
+        lessAt[c] = l;
+        equalAt[c] = e;
+        greaterAt[c] = g;
+        int size = chunkBegin(c + 1) - chunkBegin(c);
+        l += less[c];
+        e += equal[c];
+        g += size - less[c] - equal[c];
+    }
+
+    pool.parallelFor(chunks, [&](int c) {
+        int li = lessAt[c], ei = equalAt[c], gi = greaterAt[c];
+        for (int i = chunkBegin(c); i < chunkBegin(c + 1); i++) {
+            int x = arr[i];
+            if (x < pivot) tmp[li++] = x;
+            else if (x == pivot) tmp[ei++] = x;
+            else tmp[gi++] = x;
+        }
+    });
+    pool.parallelFor(chunks, [&](int c) {
+        copy(tmp.begin() + chunkBegin(c), tmp.begin() + chunkBegin(c + 1), arr.begin() + chunkBegin(c));
+    });
+
+    lt = low + totalLess - 1;
+    gt = low + totalLess + totalEqual;
+}
+
+// Sorts arr[low..high] as pool tasks: one side of each partition becomes a
+// new task (stealable by idle threads) and the other is continued in place
+void parallelSortTask(WorkStealingPool &pool, vector<int>& arr, vector<int>& tmp,
+                      int low, int high, atomic<int> &pending) {
+    long long share = (long long)arr.size() / pool.size();
+    WorkerPivot pickPivot;
+    while (high - low + 1 > PARALLEL_CUTOFF) {
+        int leftHigh, rightLow;
+        if (pool.size() > 1 && high - low + 1 >= PARALLEL_PARTITION_MIN && high - low + 1 > share) {
+            // Too few tasks exist yet to keep every thread busy
+            parallelThreeWayPartition(pool, arr, tmp, low, high, pickPivot(low, high), leftHigh, rightLow);
+        } else {
+            int p = blockPartitionAt(arr, low, high, pickPivot(low, high));
+            leftHigh = p - 1;
+            rightLow = p + 1;
+        }
+
+        pending++;
+        pool.spawn([&pool, &arr, &tmp, &pending, low, leftHigh] {
+            parallelSortTask(pool, arr, tmp, low, leftHigh, pending);
+        });
+        low = rightLow;
+    }
+    hybridQuickSort(arr, low, high, pickPivot);
+    pending--;
+}
+
+void parallelQuickSort(vector<int>& arr, int threads) {
+    if (arr.size() <= PARALLEL_CUTOFF || threads <= 1) {
+        hybridQuickSort(arr, 0, (int)arr.size() - 1);
+        return;
+    }
+
+    vector<int> tmp(arr.size()); // Scratch space of the parallel partitions
+    WorkStealingPool pool(threads);
+    atomic<int> pending(1);
+    parallelSortTask(pool, arr, tmp, 0, (int)arr.size() - 1, pending);
+    pool.helpUntilDone(pending);
+}
+
+// ---------------------- DUAL-PIVOT QUICKSORT (YAROSLAVSKIY) -----------------------
+
+// Splits around two random pivots p <= q in one pass, as in Java's sort:
+// keys < p go left, keys > q go right, the rest stay in the middle. Each
+// level cuts the range in three, so there are fewer passes over memory.
+void dualPivotQuickSort(vector<int>& arr, int low, int high) {
+    while (high - low + 1 > INSERTION_CUTOFF) {
+        int n = high - low + 1;
+        swap(arr[low + rand() % n], arr[low]);
+        swap(arr[low + 1 + rand() % (n - 1)], arr[high]);
+        if (arr[low] > arr[high]) swap(arr[low], arr[high]);
+        int p = arr[low], q = arr[high];
+
+        // arr[low+1..l-1] < p, arr[l..k-1] in [p, q], arr[g+1..high-1] > q
+        int l = low + 1, g = high - 1;
+        for (int k = l; k <= g; k++) {
+            if (arr[k] < p) {
+                swap(arr[k], arr[l]);
+                l++;
+            } else if (arr[k] > q) {
+                while (arr[g] > q && k < g) g--;
+                swap(arr[k], arr[g]);
+                g--;
+                if (arr[k] < p) {
+                    swap(arr[k], arr[l]);
+                    l++;
+                }
+            }
+        }
+        l--;
+        g++;
+        swap(arr[low], arr[l]);
+        swap(arr[high], arr[g]);
+
+        // Pivots are now at l and g; the middle is arr[midLow..midHigh]
+        int midLow = l + 1, midHigh = g - 1;
+        if (p == q) {
+            // The middle holds only copies of the pivot: nothing left to sort
+            midLow = l + 1;
+            midHigh = l;
+        } else if (midHigh - midLow + 1 > n * 2 / 3) {
+            // A large middle usually means many keys equal a pivot: move those
+            // to its ends so they are not partitioned again
+            for (int k = midLow; k <= midHigh; k++) {
+                if (arr[k] == p) {
+                    swap(arr[k], arr[midLow]);
+                    midLow++;
+                } else if (arr[k] == q) {
+                    while (arr[midHigh] == q && k < midHigh) midHigh--;
+                    swap(arr[k], arr[midHigh]);
+                    midHigh--;
+                    if (arr[k] == p) {
+                        swap(arr[k], arr[midLow]);
+                        midLow++;
+                    }
+                }
+            }
+        }
+
+        // Recurse into the two smaller parts and loop on the largest one:
+        // each recursive call gets at most half the range, so the stack
+        // never holds more than log2(n) frames
+        int parts[3][2] = {{low, l - 1}, {midLow, midHigh}, {g + 1, high}};
+        int largest = 0;
+        for (int i = 1; i < 3; i++) {
+            if (parts[i][1] - parts[i][0] > parts[largest][1] - parts[largest][0]) largest = i;
+        }
+        for (int i = 0; i < 3; i++) {
+            if (i != largest) dualPivotQuickSort(arr, parts[i][0], parts[i][1]);
+        }
+        low = parts[largest][0];
+        high = parts[largest][1];
+    }
+    insertionSort(arr, low, high);
+}
+
+// ---------------------- SAMPLE SORT -----------------------
+
+// Buckets per level; the bucket index of a key fits in one byte
+const int SAMPLE_LOG_BUCKETS = 8;
+const int SAMPLE_BUCKETS = 1 << SAMPLE_LOG_BUCKETS;
+
+// Sample keys per bucket: more gives more even buckets
+const int SAMPLE_OVERSAMPLING = 16;
+
+// Buckets at or below this size (256 KB of keys) are sorted directly
+const int SAMPLE_SORT_BASE = 1 << 16;
+
+// Sorts data[0..n) with buffer[0..n) as scratch. One level picks 255
+// splitters from a random sample, finds each key's bucket with a branchless
+// walk of the splitters stored as an implicit search tree, counts the
+// buckets and scatters the keys into buffer. That is two passes over the
+// data for a 256-way split, where quicksort needs eight 2-way passes.
+void sampleSortRange(int *data, int *buffer, int n, vector<unsigned char> &oracle) {
+    if (n <= SAMPLE_SORT_BASE) {
+        sort_engine::sort(data, data + n);
+        return;
+    }
+
+    // Every SAMPLE_OVERSAMPLING-th key of a sorted random sample is a splitter
+    mt19937 gen(rand());
+    vector<int> sample(SAMPLE_BUCKETS * SAMPLE_OVERSAMPLING);
+    for (int &x : sample) x = data[gen() % n];
+    sort_engine::sort(sample.begin(), sample.end());
+
+    // tree[1..SAMPLE_BUCKETS-1] in breadth-first order: the children of node
+    // j are 2j and 2j + 1, and the leaves j >= SAMPLE_BUCKETS are the buckets
+    int tree[SAMPLE_BUCKETS];
+    function<void(int, int, int)> build = [&](int node, int lo, int hi) {
+        if (node >= SAMPLE_BUCKETS) return;
+        int mid = (lo + hi) / 2;
+        tree[node] = sample[mid * SAMPLE_OVERSAMPLING];
+        build(2 * node, lo, mid);
+        build(2 * node + 1, mid, hi);
+    };
+    build(1, 0, SAMPLE_BUCKETS);
+
+    // Bucket b holds the keys between splitters b - 1 (exclusive) and b (inclusive)
+    int counts[SAMPLE_BUCKETS] = {0};
+    for (int i = 0; i < n; i++) {
+        int x = data[i];
+        unsigned j = 1;
+        for (int level = 0; level < SAMPLE_LOG_BUCKETS; level++)
+            j = 2 * j + (x > tree[j]);
+        oracle[i] = (unsigned char)(j - SAMPLE_BUCKETS);
+        counts[j - SAMPLE_BUCKETS]++;
+    }
+
+    int starts[SAMPLE_BUCKETS + 1];
+    starts[0] = 0;
+    for (int b = 0; b < SAMPLE_BUCKETS; b++) starts[b + 1] = starts[b] + counts[b];
+
+    int next[SAMPLE_BUCKETS];
+    copy(starts, starts + SAMPLE_BUCKETS, next);
+    for (int i = 0; i < n; i++)
+        buffer[next[oracle[i]]++] = data[i];
+
+    for (int b = 0; b < SAMPLE_BUCKETS; b++) {
+        int size = counts[b];
+        int *bucket = buffer + starts[b];
+        if (size == n) {
+            // Splitters all equal: no progress to be made by sampling again
+            sort_engine::sort(bucket, bucket + size);
+        } else if (size > SAMPLE_SORT_BASE) {
+            sampleSortRange(bucket, data + starts[b], size, oracle);
+        } else {
+            sort_engine::sort(bucket, bucket + size);
+        }
+        copy(bucket, bucket + size, data + starts[b]);
+    }
+}
+
+void sampleSort(vector<int>& arr) {
+    if ((int)arr.size() <= SAMPLE_SORT_BASE) {
+        sort_engine::sort(arr.begin(), arr.end());
+        return;
+    }
+    vector<int> buffer(arr.size());
+    vector<unsigned char> oracle(arr.size());
+    sampleSortRange(arr.data(), buffer.data(), arr.size(), oracle);
+}
+
+// ---------------------- RADIX SORTS -----------------------
+
+// Bits per radix digit: a 256-entry histogram stays in L1
+const int RADIX_BITS = 8;
+const int RADIX_BUCKETS = 1 << RADIX_BITS;
+
+// Keys ahead of the scatter whose destination slot is prefetched
+const int RADIX_PREFETCH_DISTANCE = 16;
+
+// Buckets at or below this size end the American flag recursion
+const int AMERICAN_FLAG_BASE = 64;
+
+// Keys are sorted as x - minKey, which fits in 32 unsigned bits and orders
+// like the signed keys; only the low 'passes' digits of it are ever nonzero
+inline unsigned radixDigit(int x, unsigned minKey, int shift) {
+    return (((unsigned)x - minKey) >> shift) & (RADIX_BUCKETS - 1);
+}
+
+// LSD radix sort over the low 'passes' digits. One read pass fills every
+// digit's histogram, and a digit all keys share is skipped, so no pass
+// moves the data without ordering it. While scattering, the slot the key
+// RADIX_PREFETCH_DISTANCE places ahead will be written to is prefetched:
+// the 256 write positions jump around memory and are what stalls the loop.
+void lsdRadixSort(vector<int>& arr, unsigned minKey, int passes) {
+    int n = arr.size();
+    if (n < 2 || passes == 0) return;
+
+    vector<array<int, RADIX_BUCKETS>> counts(passes);
+    for (auto &c : counts) c.fill(0);
+    for (int i = 0; i < n; i++) {
+        unsigned u = (unsigned)arr[i] - minKey;
+        for (int d = 0; d < passes; d++)
+            counts[d][(u >> (d * RADIX_BITS)) & (RADIX_BUCKETS - 1)]++;
+    }
+
+    vector<int> buffer(n);
+    int *src = arr.data(), *dst = buffer.data();
+    for (int d = 0; d < passes; d++) {
+        const array<int, RADIX_BUCKETS> &c = counts[d];
+        if (*max_element(c.begin(), c.end()) == n) continue; // Every key has this digit
+
+        int next[RADIX_BUCKETS];
+        int sum = 0;
+        for (int b = 0; b < RADIX_BUCKETS; b++) {
+            next[b] = sum;
+            sum += c[b];
+        }
+
+        int shift = d * RADIX_BITS;
+        int i = 0;
+        for (; i < n - RADIX_PREFETCH_DISTANCE; i++) {
+            __builtin_prefetch(dst + next[radixDigit(src[i + RADIX_PREFETCH_DISTANCE], minKey, shift)], 1);
+            dst[next[radixDigit(src[i], minKey, shift)]++] = src[i];
+        }
+        for (; i < n; i++)
+            dst[next[radixDigit(src[i], minKey, shift)]++] = src[i];
+        swap(src, dst);
+    }
+    if (src != arr.data()) copy(src, src + n, arr.data());
+}
+
+// In-place MSD radix sort (McIlroy, Bostic and McIlroy's American flag
+// sort) of a[0..n) on the digit at 'shift' and every digit below it.
+// Keys are cycled straight into their bucket's next free slot, so no
+// buffer is needed; each bucket is then sorted on the next digit down,
+// and small ones go to sort_engine instead of another 256-way pass.
+void americanFlagSort(int *a, int n, unsigned minKey, int shift) {
+    if (n <= AMERICAN_FLAG_BASE) {
+        sort_engine::sort(a, a + n);
+        return;
+    }
+
+    int counts[RADIX_BUCKETS] = {0};
+    for (int i = 0; i < n; i++) counts[radixDigit(a[i], minKey, shift)]++;
+
+    int heads[RADIX_BUCKETS], tails[RADIX_BUCKETS];
+    int sum = 0;
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        heads[b] = sum;
+        sum += counts[b];
+        tails[b] = sum;
+    }
+
+    // Swap each misplaced key into the bucket it belongs to until the
+    // key brought back belongs here
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        while (heads[b] < tails[b]) {
+            int x = a[heads[b]];
+            unsigned d = radixDigit(x, minKey, shift);
+            while (d != (unsigned)b) {
+                swap(x, a[heads[d]++]);
+                d = radixDigit(x, minKey, shift);
+            }
+            a[heads[b]++] = x;
+        }
+    }
+
+    if (shift == 0) return;
+    int start = 0;
+    for (int b = 0; b < RADIX_BUCKETS; b++) {
+        if (counts[b] > 1) americanFlagSort(a + start, counts[b], minKey, shift - RADIX_BITS);
+        start += counts[b];
+    }
+}
+
+// ---------------------- ADAPTIVE FRONT END -----------------------
+
+// Below this many keys a radix level costs more than the comparisons it saves
+const int RADIX_MIN_SIZE = AMERICAN_FLAG_BASE;
+
+// Above this many keys (a 256 MiB buffer) only the in-place radix sort is used
+const int RADIX_BUFFER_LIMIT = 1 << 26;
+
+enum SortChoice { CHOICE_QUICKSORT, CHOICE_LSD_RADIX, CHOICE_MSD_RADIX };
+
+const char *sortChoiceName(SortChoice c) {
+    switch (c) {
+        case CHOICE_LSD_RADIX: return "lsd_radix";
+        case CHOICE_MSD_RADIX: return "msd_radix";
+        default: return "quicksort";
+    }
+}
+
+// What adaptiveSort() does with one input, from its size and key range
+struct SortPlan {
+    SortChoice choice = CHOICE_QUICKSORT;
+    unsigned minKey = 0;
+    int passes = 0; // Radix digits spanned by max - min
+};
+
+// Tiny inputs stay with the randomized quicksort. Otherwise the span of the
+// keys sets the number of digits. LSD makes one pass per digit, each with a
+// 256-bucket prefix sum, which wins once n is large next to that. With few
+// keys spread over many digits, the American flag sort is ahead: a single
+// level leaves buckets small enough for sort_engine. It is also used when
+// LSD's buffer would be too large, since it sorts in place.
+SortPlan planSort(const vector<int>& arr) {
+    SortPlan plan;
+    int n = arr.size();
+    if (n < RADIX_MIN_SIZE) return plan;
+
+    auto [lo, hi] = minmax_element(arr.begin(), arr.end());
+    unsigned range = (unsigned)*hi - (unsigned)*lo;
+    plan.minKey = (unsigned)*lo;
+    for (; range > 0; range >>= RADIX_BITS) plan.passes++;
+
+    // No passes means every key is equal: LSD returns without touching them
+    if (plan.passes > 0 && (n > RADIX_BUFFER_LIMIT || n < plan.passes * RADIX_BUCKETS))
+        plan.choice = CHOICE_MSD_RADIX;
+    else
+        plan.choice = CHOICE_LSD_RADIX;
+    return plan;
+}
+
+void adaptiveSort(vector<int>& arr) {
+    SortPlan plan = planSort(arr);
+    switch (plan.choice) {
+        case CHOICE_LSD_RADIX:
+            lsdRadixSort(arr, plan.minKey, plan.passes);
+            break;
+        case CHOICE_MSD_RADIX:
+            americanFlagSort(arr.data(), arr.size(), plan.minKey, (plan.passes - 1) * RADIX_BITS);
+            break;
+        default:
+            hybridQuickSort(arr, 0, arr.size() - 1);
+    }
+}
+
 // ---------------------- CSV LOADER -----------------------
 
 vector<int> loadCSV(string filename) {
@@ -78,11 +1076,12 @@ struct Stats {
     double total = 0;
 };
 
-Stats benchmark(function<void(vector<int>&)> sorter, vector<int> arr, int runs) {
+template <class T, class Sorter>
+Stats benchmark(Sorter sorter, vector<T> arr, int runs) {
     Stats s;
 
     for (int i = 0; i < runs; i++) {
-        vector<int> copy = arr;
+        vector<T> copy = arr;
 
         auto start = chrono::high_resolution_clock::now();
         sorter(copy);
@@ -96,11 +1095,366 @@ Stats benchmark(function<void(vector<int>&)> sorter, vector<int> arr, int runs)
     return s;
 }
 
+// ---------------------- SORT ENGINES -----------------------
+
+// One benchmarked sort: its runtime_results.csv column prefix, console label and entry point
+struct SortEngine {
+    string column;
+    string label;
+    function<void(vector<int>&)> sort;
+};
+
+vector<SortEngine> sortEngines() {
+    return {
+        {"det", "Deterministic Quicksort",
+         [](vector<int> &a) { quicksortDet(a, 0, a.size() - 1); }},
+        {"rand", "Randomized Quicksort",
+         [](vector<int> &a) { randomizedQuickSort(a, 0, a.size() - 1); }},
+        {"hybrid", "Hybrid Quicksort",
+         [](vector<int> &a) { hybridQuickSort(a, 0, a.size() - 1); }},
+        {"threeway", "Three-way Quicksort",
+         [](vector<int> &a) { threeWayQuickSort(a, 0, a.size() - 1); }},
+        {"block", "Block Quicksort",
+         [](vector<int> &a) { blockQuickSort(a, 0, a.size() - 1); }},
+        {"simd", "Vectorized Quicksort",
+         [](vector<int> &a) { vectorizedQuickSort(a, 0, a.size() - 1); }},
+        {"dualpivot", "Dual-pivot Quicksort",
+         [](vector<int> &a) { dualPivotQuickSort(a, 0, a.size() - 1); }},
+        {"samplesort", "Sample sort",
+         [](vector<int> &a) { sampleSort(a); }},
+        {"engine", "Template engine",
+         [](vector<int> &a) { sort_engine::sort(a.begin(), a.end()); }},
+        {"adaptive", "Adaptive (radix/quick)",
+         [](vector<int> &a) { adaptiveSort(a); }},
+        {"parallel", "Parallel Quicksort",
+         [](vector<int> &a) { parallelQuickSort(a, thread::hardware_concurrency()); }},
+    };
+}
+
+// ---------------------- KEY TYPES -----------------------
+
+// The same dataset shapes, re-keyed as the types sort_engine.hpp is meant for.
+// Every conversion preserves the order and the duplicates of the int keys.
+
+struct Record {
+    long long key;
+    long long payload;
+};
+
+// Fixed-length string prefix: 8 hex digits, so byte order is key order
+typedef array<char, 8> Prefix8;
+
+Prefix8 toPrefix(int x) {
+    static const char HEX[] = "0123456789abcdef";
+    unsigned u = (unsigned)x ^ 0x80000000u; // Signed order as unsigned order
+    Prefix8 p;
+    for (int i = 7; i >= 0; i--, u >>= 4) p[i] = HEX[u & 15];
+    return p;
+}
+
+// A prefix read as a big-endian integer orders the same as the bytes
+uint64_t prefixKey(const Prefix8 &p) {
+    uint64_t k = 0;
+    for (char c : p) k = (k << 8) | (unsigned char)c;
+    return k;
+}
+
+// Times sort_engine::sort against std::sort on one type and writes a row
+template <class T, class EngineSort, class StdSort>
+void benchmarkType(ofstream &out, const string &dataset, const string &type, const vector<T> &arr,
+                   int runs, EngineSort engineSort, StdSort stdSort) {
+    Stats eng = benchmark(engineSort, arr, runs);
+    Stats ref = benchmark(stdSort, arr, runs);
+
+    cout << "  " << left << setw(12) << type << "engine avg: " << eng.total / runs
+         << "  std::sort avg: " << ref.total / runs << "\n";
+
+    out << dataset << "," << type << ","
+        << eng.best << "," << eng.total / runs << "," << eng.worst << ","
+        << ref.best << "," << ref.total / runs << "," << ref.worst << "\n";
+}
+
+void benchmarkKeyTypes(ofstream &out, const string &dataset, const vector<int> &arr, int runs) {
+    vector<long long> wide;
+    vector<float> reals;
+    vector<Prefix8> prefixes;
+    vector<Record> records;
+    for (size_t i = 0; i < arr.size(); i++) {
+        wide.push_back((long long)arr[i] * 4294967311LL);
+        reals.push_back(arr[i] / 3.0f);
+        prefixes.push_back(toPrefix(arr[i]));
+        records.push_back({(long long)arr[i] * 4294967311LL, (long long)i});
+    }
+
+    cout << "Key types (sort_engine vs std::sort):\n";
+    benchmarkType(out, dataset, "int64", wide, runs,
+        [](vector<long long> &a) { sort_engine::sort(a.begin(), a.end()); },
+        [](vector<long long> &a) { sort(a.begin(), a.end()); });
+    benchmarkType(out, dataset, "float", reals, runs,
+        [](vector<float> &a) { sort_engine::sort(a.begin(), a.end()); },
+        [](vector<float> &a) { sort(a.begin(), a.end()); });
+
+    // Byte-wise comparison takes the Hoare path; the integer key the branchless one
+    benchmarkType(out, dataset, "prefix8", prefixes, runs,
+        [](vector<Prefix8> &a) { sort_engine::sort(a.begin(), a.end()); },
+        [](vector<Prefix8> &a) { sort(a.begin(), a.end()); });
+    benchmarkType(out, dataset, "prefix8_key", prefixes, runs,
+        [](vector<Prefix8> &a) { sort_engine::sort(a.begin(), a.end(), less<>(), prefixKey); },
+        [](vector<Prefix8> &a) {
+            sort(a.begin(), a.end(),
+                 [](const Prefix8 &x, const Prefix8 &y) { return prefixKey(x) < prefixKey(y); });
+        });
+
+    auto recordKey = [](const Record &r) { return r.key; };
+    benchmarkType(out, dataset, "record", records, runs,
+        [&](vector<Record> &a) { sort_engine::sort(a.begin(), a.end(), less<>(), recordKey); },
+        [](vector<Record> &a) {
+            sort(a.begin(), a.end(), [](const Record &x, const Record &y) { return x.key < y.key; });
+        });
+}
+
+// ---------------------- BRANCH-MISS COUNTER -----------------------
+
+// Counts mispredicted branches of the calling thread (user space only).
+// Linux only; available() is false elsewhere, or when the kernel or VM
+// exposes no hardware counters.
+struct BranchMissCounter {
+    int fd = -1;
+
+    BranchMissCounter() {
+#ifdef __linux__
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+    }
+
+    ~BranchMissCounter() {
+#ifdef __linux__
+        if (fd >= 0) close(fd);
+#endif
+    }
+
+    bool available() const { return fd >= 0; }
+
+    void start() {
+#ifdef __linux__
+        if (fd < 0) return;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+
+    long long stop() {
+        long long count = 0;
+#ifdef __linux__
+        if (fd < 0) return 0;
+        ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd, &count, sizeof(count)) != sizeof(count)) count = 0;
+#endif
+        return count;
+    }
+};
+
+// ---------------------- PARTITION KERNELS -----------------------
+
+// One partition pass over n random keys per kernel: throughput and branch misses.
+// Run i reseeds rand(), so every kernel partitions around the same pivots.
+void benchmarkPartitionKernels(int n) {
+    struct Kernel {
+        string label;
+        function<int(vector<int>&, int, int)> partition;
+    };
+    vector<Kernel> kernels = {
+        {"Lomuto", randomizedLomutoPartition},
+        {"Hoare", randomizedHoarePartition},
+        {"Block", blockPartition},
+    };
+    if (bestSimdLevel() >= SIMD_AVX2)
+        kernels.push_back({"AVX2", [](vector<int> &a, int low, int high) {
+                               return vectorizedPartition(a, low, high, SIMD_AVX2);
+                           }});
+    if (bestSimdLevel() >= SIMD_AVX512)
+        kernels.push_back({"AVX-512", [](vector<int> &a, int low, int high) {
+                               return vectorizedPartition(a, low, high, SIMD_AVX512);
+                           }});
+
+    mt19937 gen(n);
+    vector<int> arr(n);
+    for (int &x : arr) x = (int)gen();
+
+    BranchMissCounter counter;
+    int runs = 10;
+    cout << "Partition kernels, n = " << n << " random keys (average of " << runs << " runs)\n";
+    if (!counter.available())
+        cout << "Hardware branch-miss counter unavailable: misses shown as n/a\n";
+    cout << "\n";
+
+    for (const Kernel &k : kernels) {
+        double total = 0;
+        long long misses = 0;
+        for (int i = 0; i < runs; i++) {
+            vector<int> copy = arr;
+            srand(i + 1);
+
+            counter.start();
+            auto start = chrono::high_resolution_clock::now();
+            k.partition(copy, 0, n - 1);
+            auto end = chrono::high_resolution_clock::now();
+            misses += counter.stop();
+
+            total += chrono::duration<double, milli>(end - start).count();
+        }
+
+        // Averaged, not best: a lopsided pivot makes a cheap, well-predicted pass
+        double avg = total / runs;
+
+        cout << left << setw(8) << k.label << "-> " << avg << " ms  ("
+             << n / (avg / 1000) << " elements/s)  branch misses/element: ";
+        if (counter.available())
+            cout << (double)misses / runs / n << "\n";
+        else
+            cout << "n/a\n";
+    }
+}
+
+// ---------------------- PARALLEL SPEEDUP -----------------------
+
+// parallelQuickSort on n random keys with 1, 2, 4, ... up to maxThreads threads.
+// The input is regenerated from the same seed for each run rather than
+// copied, so n = 10^9 needs memory for two arrays, not three.
+void benchmarkParallel(int n, int maxThreads) {
+    cout << "Parallel quicksort, n = " << n << " random keys, up to "
+         << maxThreads << " threads\n\n";
+
+    vector<int> counts;
+    for (int t = 1; t < maxThreads; t *= 2) counts.push_back(t);
+    counts.push_back(maxThreads);
+
+    double base = 0;
+    for (int threads : counts) {
+        vector<int> arr(n);
+        mt19937 gen(n);
+        for (int &x : arr) x = (int)gen();
+
+        auto start = chrono::high_resolution_clock::now();
+        parallelQuickSort(arr, threads);
+        auto end = chrono::high_resolution_clock::now();
+        double ms = chrono::duration<double, milli>(end - start).count();
+
+        if (!is_sorted(arr.begin(), arr.end())) cout << "ERROR: output not sorted\n";
+        if (threads == 1) base = ms;
+
+        cout << setw(3) << right << threads << " threads -> " << ms << " ms  ("
+             << n / (ms / 1000) << " elements/s)  speedup: " << base / ms << "\n";
+    }
+}
+
+// ---------------------- LARGE ARRAYS -----------------------
+
+// Single runs on n random keys, meant for arrays well beyond the L3 cache,
+// where each pass over the data costs a trip to main memory
+void benchmarkLarge(int n) {
+    cout << "Large arrays, n = " << n << " random keys (" << n * sizeof(int) / (1 << 20)
+         << " MiB, one run each)\n\n";
+
+    vector<int> arr(n);
+    mt19937 gen(n);
+    for (int &x : arr) x = (int)gen();
+
+    vector<SortEngine> engines = {
+        {"hybrid", "Hybrid Quicksort", [](vector<int> &a) { hybridQuickSort(a, 0, a.size() - 1); }},
+        {"dualpivot", "Dual-pivot Quicksort", [](vector<int> &a) { dualPivotQuickSort(a, 0, a.size() - 1); }},
+        {"samplesort", "Sample sort", [](vector<int> &a) { sampleSort(a); }},
+        {"adaptive", string("Adaptive (") + sortChoiceName(planSort(arr).choice) + ")",
+         [](vector<int> &a) { adaptiveSort(a); }},
+        {"std", "std::sort", [](vector<int> &a) { sort(a.begin(), a.end()); }},
+    };
+    for (const SortEngine &e : engines) {
+        Stats st = benchmark(e.sort, arr, 1);
+        cout << left << setw(24) << e.label << "-> " << st.best << " ms  ("
+             << n / (st.best / 1000) << " elements/s)\n";
+    }
+}
+
+// ---------------------- LOW-CARDINALITY INPUTS -----------------------
+
+// n keys drawn uniformly from 'distinct' values
+vector<int> makeLowCardinality(int n, int distinct, unsigned seed) {
+    mt19937 gen(seed);
+    uniform_int_distribution<int> dist(0, distinct - 1);
+    vector<int> arr(n);
+    for (int &x : arr) x = dist(gen);
+    return arr;
+}
+
+// Single runs on large arrays with few distinct keys, where the two-way
+// partitions keep re-splitting runs of equal keys
+void benchmarkLowCardinality(int n) {
+    cout << "Low-cardinality inputs, n = " << n << " (one run each)\n\n";
+
+    for (int distinct : {2, 16, 256, 65536}) {
+        vector<int> arr = makeLowCardinality(n, distinct, distinct);
+
+        Stats rnd = benchmark(
+            [&](vector<int> &a) { randomizedQuickSort(a, 0, a.size() - 1); },
+            arr, 1
+        );
+        Stats hyb = benchmark(
+            [&](vector<int> &a) { hybridQuickSort(a, 0, a.size() - 1); },
+            arr, 1
+        );
+        Stats three = benchmark(
+            [&](vector<int> &a) { threeWayQuickSort(a, 0, a.size() - 1); },
+            arr, 1
+        );
+
+        cout << "------ " << distinct << " distinct keys ------\n";
+        cout << "Randomized Quicksort    -> " << rnd.best << " ms  ("
+             << n / (rnd.best / 1000) << " elements/s)\n";
+        cout << "Hybrid Quicksort        -> " << hyb.best << " ms  ("
+             << n / (hyb.best / 1000) << " elements/s)\n";
+        cout << "Three-way Quicksort     -> " << three.best << " ms  ("
+             << n / (three.best / 1000) << " elements/s)\n\n";
+    }
+}
+
 // ---------------------- MAIN PROGRAM -----------------------
 
-int main() {
+int main(int argc, char *argv[]) {
     srand(time(NULL));
 
+    // ./main --low-cardinality <n>: large synthetic inputs instead of the datasets
+    if (argc >= 3 && string(argv[1]) == "--low-cardinality") {
+        benchmarkLowCardinality(stoi(argv[2]));
+        return 0;
+    }
+
+    // ./main --parallel <n> [threads]: speedup of the parallel sort on n random keys
+    if (argc >= 3 && string(argv[1]) == "--parallel") {
+        int maxThreads = argc >= 4 ? stoi(argv[3]) : (int)thread::hardware_concurrency();
+        benchmarkParallel(stoi(argv[2]), max(maxThreads, 1));
+        return 0;
+    }
+
+    // ./main --large <n>: single runs on n random keys, for n beyond the L3 cache
+    if (argc >= 3 && string(argv[1]) == "--large") {
+        benchmarkLarge(stoi(argv[2]));
+        return 0;
+    }
+
+    // ./main --partition-kernels <n>: one partition pass per kernel on n random keys
+    if (argc >= 3 && string(argv[1]) == "--partition-kernels") {
+        benchmarkPartitionKernels(stoi(argv[2]));
+        return 0;
+    }
+
     string folder = "qsort_datasets/";
     vector<string> files;
 
@@ -109,12 +1463,24 @@ int main() {
             files.push_back(entry.path().string());
         }
     }
+    // Directory order is unspecified; sort so every run writes the same rows
+    sort(files.begin(), files.end());
 
     int runs = 100;
 
+    vector<SortEngine> engines = sortEngines();
+
     // Create CSV output file
     ofstream out("runtime_results.csv");
-    out << "dataset_name,det_best,det_avg,det_worst,rand_best,rand_avg,rand_worst\n";
+    out << "dataset_name";
+    for (const SortEngine &e : engines)
+        out << "," << e.column << "_best," << e.column << "_avg," << e.column << "_worst";
+    // The path adaptiveSort() took on the dataset and its average throughput
+    out << ",adaptive_choice,adaptive_elements_per_sec\n";
+
+    // Per-type results of the template engine
+    ofstream typesOut("type_results.csv");
+    typesOut << "dataset_name,type,engine_best,engine_avg,engine_worst,std_best,std_avg,std_worst\n";
 
     cout << "Running " << runs << " iterations on each dataset...\n\n";
 
@@ -124,42 +1490,36 @@ int main() {
         string dataset = filesystem::path(file).filename().string();
 
         cout << "------ " << dataset << " (size = " << arr.size() << ") ------\n";
+        out << dataset;
+        double adaptiveAvg = 0;
 
-        // Deterministic QS
-        Stats det = benchmark(
-            [&](vector<int> &a) { quicksortDet(a, 0, a.size() - 1); },
-            arr, runs
-        );
-
-        // Randomized QS
-        Stats rnd = benchmark(
-            [&](vector<int> &a) { randomizedQuickSort(a, 0, a.size() - 1); },
-            arr, runs
-        );
+        for (const SortEngine &e : engines) {
+            Stats st = benchmark(e.sort, arr, runs);
+            double avg = st.total / runs;
 
-        double det_avg = det.total / runs;
-        double rnd_avg = rnd.total / runs;
+            // Print to console
+            cout << left << setw(24) << e.label << "-> Best: " << st.best
+                 << "  Worst: " << st.worst
+                 << "  Avg: " << avg << "\n";
 
-        // Print to console
-        cout << "Deterministic Quicksort -> Best: " << det.best 
-             << "  Worst: " << det.worst 
-             << "  Avg: " << det_avg << "\n";
+            // Write to CSV
+            out << "," << st.best << "," << avg << "," << st.worst;
+            if (e.column == "adaptive") adaptiveAvg = avg;
+        }
 
-        cout << "Randomized Quicksort    -> Best: " << rnd.best 
-             << "  Worst: " << rnd.worst 
-             << "  Avg: " << rnd_avg << "\n";
+        const char *choice = sortChoiceName(planSort(arr).choice);
+        double throughput = arr.size() / (adaptiveAvg / 1000);
+        cout << "Adaptive path: " << choice << " (" << throughput << " elements/s)\n";
+        out << "," << choice << "," << throughput << "\n";
 
+        benchmarkKeyTypes(typesOut, dataset, arr, runs);
         cout << "-------------------------------------------------------\n\n";
-
-        // Write to CSV
-        out << dataset << ","
-            << det.best << "," << det_avg << "," << det.worst << ","
-            << rnd.best << "," << rnd_avg << "," << rnd.worst << "\n";
     }
 
     out.close();
+    typesOut.close();
 
-    cout << "Results saved to runtime_results.csv\n";
+    cout << "Results saved to runtime_results.csv and type_results.csv\n";
 
     // Run Python plotting script
     cout << "Generating graphs using plot_qsort.py...\n";
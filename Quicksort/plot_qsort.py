@@ -11,6 +11,15 @@ x = df['dataset_name']
 plt.figure(figsize=(12, 6))
 plt.plot(x, df['det_avg'], marker='o', label='Deterministic Quicksort - Avg')
 plt.plot(x, df['rand_avg'], marker='o', label='Randomized Quicksort - Avg')
+plt.plot(x, df['hybrid_avg'], marker='o', label='Hybrid Quicksort - Avg')
+plt.plot(x, df['threeway_avg'], marker='o', label='Three-way Quicksort - Avg')
+plt.plot(x, df['block_avg'], marker='o', label='Block Quicksort - Avg')
+plt.plot(x, df['simd_avg'], marker='o', label='Vectorized Quicksort - Avg')
+plt.plot(x, df['dualpivot_avg'], marker='o', label='Dual-pivot Quicksort - Avg')
+plt.plot(x, df['samplesort_avg'], marker='o', label='Sample Sort - Avg')
+plt.plot(x, df['engine_avg'], marker='o', label='Template Engine - Avg')
+plt.plot(x, df['adaptive_avg'], marker='o', label='Adaptive Radix/Quick - Avg')
+plt.plot(x, df['parallel_avg'], marker='o', label='Parallel Quicksort - Avg')
 
 plt.title("Average Runtime Comparison")
 plt.xlabel("Dataset")
@@ -26,6 +35,15 @@ plt.show()
 plt.figure(figsize=(12, 6))
 plt.plot(x, df['det_best'], marker='o', label='Deterministic - Best')
 plt.plot(x, df['rand_best'], marker='o', label='Randomized - Best')
+plt.plot(x, df['hybrid_best'], marker='o', label='Hybrid - Best')
+plt.plot(x, df['threeway_best'], marker='o', label='Three-way - Best')
+plt.plot(x, df['block_best'], marker='o', label='Block - Best')
+plt.plot(x, df['simd_best'], marker='o', label='Vectorized - Best')
+plt.plot(x, df['dualpivot_best'], marker='o', label='Dual-pivot - Best')
+plt.plot(x, df['samplesort_best'], marker='o', label='Sample Sort - Best')
+plt.plot(x, df['engine_best'], marker='o', label='Template Engine - Best')
+plt.plot(x, df['adaptive_best'], marker='o', label='Adaptive - Best')
+plt.plot(x, df['parallel_best'], marker='o', label='Parallel - Best')
 
 plt.title("Best Case Runtime Comparison")
 plt.xlabel("Dataset")
@@ -41,6 +59,15 @@ plt.show()
 plt.figure(figsize=(12, 6))
 plt.plot(x, df['det_worst'], marker='o', label='Deterministic - Worst')
 plt.plot(x, df['rand_worst'], marker='o', label='Randomized - Worst')
+plt.plot(x, df['hybrid_worst'], marker='o', label='Hybrid - Worst')
+plt.plot(x, df['threeway_worst'], marker='o', label='Three-way - Worst')
+plt.plot(x, df['block_worst'], marker='o', label='Block - Worst')
+plt.plot(x, df['simd_worst'], marker='o', label='Vectorized - Worst')
+plt.plot(x, df['dualpivot_worst'], marker='o', label='Dual-pivot - Worst')
+plt.plot(x, df['samplesort_worst'], marker='o', label='Sample Sort - Worst')
+plt.plot(x, df['engine_worst'], marker='o', label='Template Engine - Worst')
+plt.plot(x, df['adaptive_worst'], marker='o', label='Adaptive - Worst')
+plt.plot(x, df['parallel_worst'], marker='o', label='Parallel - Worst')
 
 plt.title("Worst Case Runtime Comparison")
 plt.xlabel("Dataset")
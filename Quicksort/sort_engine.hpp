@@ -0,0 +1,214 @@
+#ifndef SORT_ENGINE_HPP
+#define SORT_ENGINE_HPP
+
+// Header-only introsort over random-access iterators, for any element type.
+//
+//     sort_engine::sort(first, last);                       // operator<
+//     sort_engine::sort(first, last, std::greater<>());     // custom order
+//     sort_engine::sort(first, last, std::less<>(),         // order by a key
+//                       [](const Record &r) { return r.key; });
+//
+// Elements are ordered by comp(key(a), key(b)). When the key is an integer
+// or floating-point type and the comparator is std::less or std::greater,
+// the partition is chosen at compile time to be the branchless block
+// partition (BlockQuicksort); every other combination uses a Hoare scan.
+// Like std::sort, comp must be a strict weak ordering (no NaN keys).
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+namespace sort_engine {
+
+// ---------------------- KEYS AND COMPARATORS -----------------------
+
+// Default key extractor: the element itself
+struct Identity {
+    template <class T>
+    const T &operator()(const T &x) const { return x; }
+};
+
+template <class Compare, class Key>
+struct is_builtin_order : std::false_type {};
+template <class Key> struct is_builtin_order<std::less<>, Key> : std::true_type {};
+template <class Key> struct is_builtin_order<std::less<Key>, Key> : std::true_type {};
+template <class Key> struct is_builtin_order<std::greater<>, Key> : std::true_type {};
+template <class Key> struct is_builtin_order<std::greater<Key>, Key> : std::true_type {};
+
+// True when comparing two keys compiles to a flag-setting instruction, so
+// the comparison result can feed arithmetic instead of a branch.
+// Specialize it for other cheap key/comparator pairs to opt them in.
+template <class Key, class Compare>
+struct is_branchless_key
+    : std::integral_constant<bool, std::is_arithmetic<Key>::value && is_builtin_order<Compare, Key>::value> {};
+
+// ---------------------- ENGINE INTERNALS -----------------------
+
+namespace detail {
+
+// Ranges at or below this size are finished with insertion sort
+const std::ptrdiff_t INSERTION_CUTOFF = 16;
+
+// Keys scanned per block by the block partition; offsets fit in one byte
+const int BLOCK_SIZE = 128;
+
+// xorshift64 for pivot positions: rand() tops out at 32767 on some
+// platforms, which cannot address large ranges
+struct PivotRng {
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+
+    std::ptrdiff_t below(std::ptrdiff_t n) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (std::ptrdiff_t)(state % (uint64_t)n);
+    }
+};
+
+// comp applied to extracted keys
+template <class Compare, class KeyOf>
+struct KeyLess {
+    Compare comp;
+    KeyOf key;
+
+    template <class T>
+    bool operator()(const T &a, const T &b) const { return comp(key(a), key(b)); }
+};
+
+template <class It, class Less>
+void insertionSort(It first, It last, Less less) {
+    if (first == last) return;
+    for (It i = std::next(first); i != last; ++i) {
+        auto value = std::move(*i);
+        It j = i;
+        for (; j != first && less(value, *std::prev(j)); --j)
+            *j = std::move(*std::prev(j));
+        *j = std::move(value);
+    }
+}
+
+// Both partitions below take the pivot at *(last - 1) and return where it
+// ends up: nothing before it orders after it, nothing after it before it.
+// Keys equal to the pivot stop both scans, so runs of them split evenly.
+
+// Hoare scan over the unpartitioned [l, r), then the pivot is swapped in
+template <class It, class Key, class KeyOf, class Compare>
+It finishHoare(It l, It r, It pivotIt, const Key &pivot, KeyOf key, Compare comp) {
+    while (true) {
+        while (l < r && comp(key(*l), pivot)) ++l;
+        while (l < r && comp(pivot, key(*std::prev(r)))) --r;
+        if (r - l <= 1) break; // A single key left here equals the pivot
+        std::iter_swap(l, std::prev(r));
+        ++l;
+        --r;
+    }
+    std::iter_swap(l, pivotIt);
+    return l;
+}
+
+// Hoare scan with ordinary branches: for comparators that branch anyway
+template <class It, class KeyOf, class Compare>
+It hoarePartition(It first, It last, KeyOf key, Compare comp) {
+    It pivotIt = std::prev(last);
+    auto pivot = key(*pivotIt);
+    return finishHoare(first, pivotIt, pivotIt, pivot, key, comp);
+}
+
+// Block partition (Edelkamp and Weiss): each side records the offsets of
+// misplaced keys by adding the comparison result to a counter, then the
+// recorded keys are swapped in pairs. Fewer than two blocks are left to the
+// Hoare scan, which re-reads any block whose offsets were not used up.
+template <class It, class KeyOf, class Compare>
+It blockPartition(It first, It last, KeyOf key, Compare comp) {
+    It pivotIt = std::prev(last);
+    auto pivot = key(*pivotIt);
+    It l = first, r = std::prev(pivotIt); // [l, r] not yet partitioned
+    unsigned char offsetsL[BLOCK_SIZE], offsetsR[BLOCK_SIZE];
+    int startL = 0, numL = 0, startR = 0, numR = 0;
+
+    while (r - l + 1 >= 2 * BLOCK_SIZE) {
+        if (numL == 0) {
+            startL = 0;
+            for (int k = 0; k < BLOCK_SIZE; k++) {
+                offsetsL[numL] = (unsigned char)k;
+                numL += !comp(key(l[k]), pivot);
+            }
+        }
+        if (numR == 0) {
+            startR = 0;
+            for (int k = 0; k < BLOCK_SIZE; k++) {
+                offsetsR[numR] = (unsigned char)k;
+                numR += !comp(pivot, key(*(r - k)));
+            }
+        }
+
+        int num = std::min(numL, numR);
+        for (int k = 0; k < num; k++)
+            std::iter_swap(l + offsetsL[startL + k], r - offsetsR[startR + k]);
+
+        numL -= num;
+        numR -= num;
+        startL += num;
+        startR += num;
+        if (numL == 0) l += BLOCK_SIZE;
+        if (numR == 0) r -= BLOCK_SIZE;
+    }
+
+    return finishHoare(l, std::next(r), pivotIt, pivot, key, comp);
+}
+
+template <bool Branchless, class It, class KeyOf, class Compare>
+void introSortLoop(It first, It last, int depthLimit, KeyOf key, Compare comp, PivotRng &rng) {
+    KeyLess<Compare, KeyOf> less{comp, key};
+
+    while (last - first > INSERTION_CUTOFF) {
+        // Too many unlucky pivots: heapsort keeps this range O(n log n)
+        if (depthLimit == 0) {
+            std::make_heap(first, last, less);
+            std::sort_heap(first, last, less);
+            return;
+        }
+        depthLimit--;
+
+        std::iter_swap(first + rng.below(last - first), std::prev(last));
+        It p;
+        if constexpr (Branchless) p = blockPartition(first, last, key, comp);
+        else p = hoarePartition(first, last, key, comp);
+
+        // Recurse into the smaller side and loop on the larger one
+        if (p - first < last - p) {
+            introSortLoop<Branchless>(first, p, depthLimit, key, comp, rng);
+            first = std::next(p);
+        } else {
+            introSortLoop<Branchless>(std::next(p), last, depthLimit, key, comp, rng);
+            last = p;
+        }
+    }
+    insertionSort(first, last, less);
+}
+
+} // namespace detail
+
+// ---------------------- PUBLIC ENTRY POINT -----------------------
+
+template <class RandomIt, class Compare = std::less<>, class KeyOf = Identity>
+void sort(RandomIt first, RandomIt last, Compare comp = Compare(), KeyOf key = KeyOf()) {
+    typedef typename std::iterator_traits<RandomIt>::value_type Value;
+    typedef typename std::decay<decltype(key(std::declval<const Value &>()))>::type Key;
+
+    std::ptrdiff_t n = last - first;
+    if (n < 2) return;
+
+    int depthLimit = 0;
+    for (std::ptrdiff_t m = n; m > 1; m >>= 1) depthLimit += 2;
+
+    detail::PivotRng rng;
+    detail::introSortLoop<is_branchless_key<Key, Compare>::value>(first, last, depthLimit, key, comp, rng);
+}
+
+} // namespace sort_engine
+
+#endif // SORT_ENGINE_HPP